@@ -0,0 +1,314 @@
+/**
+ * Solver Benchmark
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Sweeps n and C over generated instances for every solver in cpp/, separates solve time
+ *              from serialization/transport time and writes machine-readable results per commit
+ *
+ * Usage:
+ *   node bench/bench.mjs [--quick] [--counters] [--algorithms a,b] [--classes a,b] [--repeat N] [--out file]
+ *   node bench/bench.mjs --compare base.json head.json
+ *   node bench/bench.mjs --batch [--instances N]
+ *   node bench/bench.mjs --scaling [--quick] [--repeat N]
+ */
+
+import { spawn, execSync } from 'child_process'
+import { existsSync, mkdirSync, readFileSync, writeFileSync } from 'fs'
+import { dirname, join } from 'path'
+import { fileURLToPath } from 'url'
+import os from 'os'
+import { generateInstance, INSTANCE_CLASSES } from './generators.mjs'
+
+const ROOT = join(dirname(fileURLToPath(import.meta.url)), '..')
+const CPP_DIR = join(ROOT, 'cpp')
+
+export const ALGORITHMS = [
+  'knapsack_01',
+  'knapsack_complete',
+  'knapsack_multiple',
+  'knapsack_mixed',
+  'knapsack_2d',
+  'knapsack_nd',
+  'knapsack_2d_parallel',
+  'knapsack_group',
+  'knapsack_depend',
+  'knapsack_tree',
+  'knapsack_tree_parallel',
+  'knapsack_kth',
+  'knapsack_count',
+  'knapsack_mitm',
+  'knapsack_unbounded',
+  'knapsack_rolling',
+  'knapsack_fptas',
+  'knapsack_value'
+]
+
+// Trace steps grow with n * C (n * C^2 for 2d, merges for tree); larger configs are skipped
+const MAX_STEPS = 2000000
+
+function estimatedSteps(algorithm, n, capacity) {
+  if (algorithm === 'knapsack_2d') return n * (capacity + 1) * (capacity + 1)
+  if (algorithm === 'knapsack_nd' || algorithm === 'knapsack_2d_parallel') return n * (capacity + 1) * (capacity + 1)
+  if (algorithm === 'knapsack_tree' || algorithm === 'knapsack_tree_parallel') return n * (capacity + 1) * (capacity + 1)
+  if (algorithm === 'knapsack_multiple') return n * 4 * (capacity + 1)
+  if (algorithm === 'knapsack_depend') return n * 2 * (capacity + 1)
+  if (algorithm === 'knapsack_mitm') return 2 ** Math.ceil(n / 2)
+  if (algorithm === 'knapsack_unbounded') return n
+  return n * (capacity + 1)
+}
+
+function parseArgs(argv) {
+  const opts = { quick: false, repeat: 3, algorithms: ALGORITHMS, classes: Object.keys(INSTANCE_CLASSES) }
+  for (let i = 0; i < argv.length; i++) {
+    const a = argv[i]
+    if (a === '--quick') opts.quick = true
+    else if (a === '--counters') opts.counters = true
+    else if (a === '--repeat') opts.repeat = parseInt(argv[++i])
+    else if (a === '--algorithms') opts.algorithms = argv[++i].split(',')
+    else if (a === '--classes') opts.classes = argv[++i].split(',')
+    else if (a === '--out') opts.out = argv[++i]
+    else if (a === '--compare') opts.compare = [argv[++i], argv[++i]]
+    else if (a === '--batch') opts.batch = true
+    else if (a === '--instances') opts.instances = parseInt(argv[++i])
+    else if (a === '--scaling') opts.scaling = true
+  }
+  return opts
+}
+
+function solverPath(algorithm) {
+  const exe = join(CPP_DIR, `${algorithm}.exe`)
+  return existsSync(exe) ? exe : join(CPP_DIR, algorithm)
+}
+
+function gitRevision() {
+  try {
+    return execSync('git rev-parse --short HEAD', { cwd: ROOT }).toString().trim()
+  } catch {
+    return 'unknown'
+  }
+}
+
+// Run one solver process and split its cost into solve, serialization and parse time
+function runOnce(algorithm, args, counters) {
+  return new Promise((resolve, reject) => {
+    const env = counters ? { ...process.env, KNAPSACK_COUNTERS: '1' } : process.env
+    const start = process.hrtime.bigint()
+    const child = spawn(solverPath(algorithm), args, { env })
+    const chunks = []
+    child.stdout.on('data', (data) => chunks.push(data))
+    child.on('error', reject)
+    child.on('close', (code) => {
+      const wallMs = Number(process.hrtime.bigint() - start) / 1e6
+      const output = Buffer.concat(chunks)
+      const parseStart = process.hrtime.bigint()
+      let result
+      try {
+        result = JSON.parse(output.toString())
+      } catch (e) {
+        reject(new Error(`${algorithm} exit ${code}: ${e.message}`))
+        return
+      }
+      const parseMs = Number(process.hrtime.bigint() - parseStart) / 1e6
+
+      // Solve and serialize come from the solver's phase profile when it reports one; otherwise
+      // solve = the solver's own measurement and the rest of the wall time is building, writing and
+      // piping the output plus process start-up
+      const phases = result.profile?.phases
+      const solveMs = phases
+        ? phases.preprocess.wall_ms + phases.dp.wall_ms + phases.reconstruct.wall_ms
+        : result.time_ms
+      const serializeMs = phases ? phases.serialize.wall_ms + phases.write.wall_ms : Math.max(0, wallMs - solveMs)
+      resolve({
+        wall_ms: wallMs,
+        solve_ms: solveMs,
+        serialize_ms: serializeMs,
+        startup_ms: phases ? Math.max(0, wallMs - result.profile.total_wall_ms) : undefined,
+        peak_rss_bytes: result.profile?.peak_rss_bytes,
+        counters: result.profile?.counters,
+        parse_ms: parseMs,
+        output_bytes: output.length,
+        max_value: result.max_value
+      })
+    })
+  })
+}
+
+// Feed instance lines to knapsack_batch and return its summary line
+function runBatch(lines, threads) {
+  return new Promise((resolve, reject) => {
+    const child = spawn(solverPath('knapsack_batch'), ['--threads', threads.toString()])
+    let output = ''
+    child.stdout.on('data', (data) => (output += data.toString()))
+    child.on('error', reject)
+    child.on('close', () => {
+      const last = output.trimEnd().split('\n').pop()
+      resolve(JSON.parse(last).summary)
+    })
+    child.stdin.end(lines.join('\n') + '\n')
+  })
+}
+
+// Many small instances: one spawn per instance vs one batch process at increasing thread counts
+async function runBatchSweep(opts) {
+  const count = opts.instances || 2000
+  const algorithms = ['knapsack_01', 'knapsack_group', 'knapsack_tree', 'knapsack_multiple']
+  const instances = Array.from({ length: count }, (_, i) => {
+    const algorithm = algorithms[i % algorithms.length]
+    return { algorithm, args: generateInstance(algorithm, 'uncorrelated', 20, 100, i + 1) }
+  })
+
+  const sample = instances.slice(0, Math.min(200, count))
+  const spawnStart = process.hrtime.bigint()
+  for (const { algorithm, args } of sample) await runOnce(algorithm, args)
+  const spawnMs = Number(process.hrtime.bigint() - spawnStart) / 1e6
+  const spawnThroughput = (sample.length * 1000) / spawnMs
+  console.log(`spawn per instance      ${spawnThroughput.toFixed(0)} instances/s`)
+
+  const lines = instances.map(({ algorithm, args }, i) => `${i} ${algorithm} ${args.join(' ')}`)
+  const results = [{ mode: 'spawn', threads: 1, throughput_per_s: spawnThroughput }]
+  for (let threads = 1; threads <= os.cpus().length; threads *= 2) {
+    const summary = await runBatch(lines, threads)
+    results.push({ mode: 'batch', ...summary })
+    console.log(
+      `batch threads=${String(threads).padEnd(3)}      ${summary.throughput_per_s.toFixed(0)} instances/s  ` +
+        `latency p50 ${summary.latency_ms.p50.toFixed(2)}ms p99 ${summary.latency_ms.p99.toFixed(2)}ms  ` +
+        `steals ${summary.steals}`
+    )
+  }
+  return results
+}
+
+// One fixed 2D instance on 1, 2, 4, ... threads up to the core count: speedup and efficiency against 1 thread
+async function runScalingSweep(opts) {
+  const capacity = opts.quick ? 500 : 2000
+  const args = generateInstance('knapsack_2d_parallel', 'uncorrelated', 100, capacity, 1)
+  const cpus = os.cpus().length
+  const counts = []
+  for (let threads = 1; threads < cpus; threads *= 2) counts.push(threads)
+  counts.push(cpus)
+
+  const results = []
+  for (const threads of counts) {
+    const runs = []
+    for (let r = 0; r < opts.repeat; r++) {
+      runs.push(await runOnce('knapsack_2d_parallel', [...args, '--threads', threads.toString()]))
+    }
+    const solveMs = median(runs.map((x) => x.solve_ms))
+    const speedup = results.length > 0 ? results[0].solve_ms / solveMs : 1
+    results.push({ threads, n: 100, capacity, solve_ms: solveMs, speedup, efficiency: speedup / threads })
+    console.log(
+      `threads=${String(threads).padEnd(3)} solve ${solveMs.toFixed(2)}ms  speedup x${speedup.toFixed(2)}  ` +
+        `efficiency ${((speedup / threads) * 100).toFixed(0)}%`
+    )
+  }
+  return results
+}
+
+function median(values) {
+  const sorted = [...values].sort((a, b) => a - b)
+  return sorted[Math.floor(sorted.length / 2)]
+}
+
+async function runSweep(opts) {
+  const sizes = opts.quick ? [10, 40] : [10, 40, 160, 640]
+  const capacities = opts.quick ? [50, 200] : [50, 200, 1000, 5000]
+  const results = []
+
+  for (const algorithm of opts.algorithms) {
+    if (!existsSync(solverPath(algorithm))) {
+      console.warn(`skip ${algorithm}: not compiled`)
+      continue
+    }
+    for (const cls of opts.classes) {
+      for (const n of sizes) {
+        for (const capacity of capacities) {
+          if (estimatedSteps(algorithm, n, capacity) > MAX_STEPS) continue
+          const args = generateInstance(algorithm, cls, n, capacity, n * 7919 + capacity)
+          const runs = []
+          for (let r = 0; r < opts.repeat; r++) runs.push(await runOnce(algorithm, args, opts.counters))
+
+          const row = {
+            algorithm,
+            class: cls,
+            n,
+            capacity,
+            repeat: opts.repeat,
+            wall_ms: median(runs.map((x) => x.wall_ms)),
+            solve_ms: median(runs.map((x) => x.solve_ms)),
+            serialize_ms: median(runs.map((x) => x.serialize_ms)),
+            parse_ms: median(runs.map((x) => x.parse_ms)),
+            startup_ms: runs[0].startup_ms === undefined ? undefined : median(runs.map((x) => x.startup_ms)),
+            peak_rss_bytes: runs[0].peak_rss_bytes,
+            counters: runs[0].counters,
+            output_bytes: runs[0].output_bytes,
+            max_value: runs[0].max_value
+          }
+          results.push(row)
+          console.log(
+            `${algorithm.padEnd(18)} ${cls.padEnd(28)} n=${String(n).padEnd(4)} C=${String(capacity).padEnd(5)} ` +
+              `solve ${row.solve_ms.toFixed(2)}ms  serialize ${row.serialize_ms.toFixed(2)}ms  ` +
+              `parse ${row.parse_ms.toFixed(2)}ms  ${(row.output_bytes / 1024).toFixed(0)}KB` +
+              (row.counters?.available
+                ? `  ipc ${row.counters.ipc?.toFixed(2)}  cells/cycle ${row.counters.cells_per_cycle?.toFixed(3)}`
+                : '')
+          )
+        }
+      }
+    }
+  }
+  return results
+}
+
+// Key identifying the same configuration across two result files
+function configKey(r) {
+  return `${r.algorithm}|${r.class}|${r.n}|${r.capacity}`
+}
+
+function compare(basePath, headPath) {
+  const base = JSON.parse(readFileSync(basePath, 'utf8'))
+  const head = JSON.parse(readFileSync(headPath, 'utf8'))
+  const baseRows = new Map(base.results.map((r) => [configKey(r), r]))
+  console.log(`base ${base.revision}  ->  head ${head.revision}`)
+  for (const r of head.results) {
+    const b = baseRows.get(configKey(r))
+    if (!b) continue
+    const solve = r.solve_ms / b.solve_ms
+    const serialize = r.serialize_ms / b.serialize_ms
+    const changed = b.max_value !== r.max_value ? '  RESULT CHANGED' : ''
+    console.log(
+      `${configKey(r).padEnd(56)} solve x${solve.toFixed(2)}  serialize x${serialize.toFixed(2)}${changed}`
+    )
+  }
+}
+
+async function main() {
+  const opts = parseArgs(process.argv.slice(2))
+  if (opts.compare) {
+    compare(...opts.compare)
+    return
+  }
+
+  const revision = gitRevision()
+  const mode = opts.batch ? '-batch' : opts.scaling ? '-scaling' : ''
+  const results = opts.batch
+    ? await runBatchSweep(opts)
+    : opts.scaling
+      ? await runScalingSweep(opts)
+      : await runSweep(opts)
+  const report = {
+    revision,
+    date: new Date().toISOString(),
+    host: { platform: process.platform, arch: process.arch, cpus: os.cpus().length, model: os.cpus()[0]?.model },
+    results
+  }
+  const out = opts.out || join(ROOT, 'bench', 'results', `${revision}${mode}.json`)
+  mkdirSync(dirname(out), { recursive: true })
+  writeFileSync(out, JSON.stringify(report, null, 2))
+  console.log(`wrote ${out}`)
+}
+
+main().catch((e) => {
+  console.error(e)
+  process.exit(1)
+})
@@ -0,0 +1,137 @@
+/**
+ * Benchmark Instance Generators
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Seeded generators for the classic Pisinger instance classes plus group, tree and
+ *              dependency shapes. Each generator returns the solver argv for one algorithm.
+ */
+
+// Deterministic PRNG (mulberry32) so every commit benchmarks the same instances
+export function createRandom(seed) {
+  let a = seed >>> 0
+  const next = () => {
+    a = (a + 0x6d2b79f5) >>> 0
+    let t = a
+    t = Math.imul(t ^ (t >>> 15), t | 1)
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61)
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296
+  }
+  // Uniform integer in [lo, hi]
+  next.int = (lo, hi) => lo + Math.floor(next() * (hi - lo + 1))
+  return next
+}
+
+// Pisinger classes over weights in [1, R]
+export const INSTANCE_CLASSES = {
+  uncorrelated: (rand, R) => {
+    const w = rand.int(1, R)
+    return { w, v: rand.int(1, R) }
+  },
+  weakly_correlated: (rand, R) => {
+    const w = rand.int(1, R)
+    const spread = Math.max(1, Math.floor(R / 10))
+    return { w, v: Math.max(1, rand.int(w - spread, w + spread)) }
+  },
+  strongly_correlated: (rand, R) => {
+    const w = rand.int(1, R)
+    return { w, v: w + Math.max(1, Math.floor(R / 10)) }
+  },
+  inverse_strongly_correlated: (rand, R) => {
+    const v = rand.int(1, R)
+    return { w: v + Math.max(1, Math.floor(R / 10)), v }
+  },
+  subset_sum: (rand, R) => {
+    const w = rand.int(1, R)
+    return { w, v: w }
+  }
+}
+
+function pisingerItems(rand, cls, n, R) {
+  return Array.from({ length: n }, () => INSTANCE_CLASSES[cls](rand, R))
+}
+
+// Random recursive tree: item i hangs under a random earlier item, a few stay roots (1-based parents)
+function treeParents(rand, n) {
+  return Array.from({ length: n }, (_, i) => (i === 0 || rand() < 0.1 ? 0 : rand.int(1, i)))
+}
+
+// Main items with up to maxFanOut attachments each (1-based parents, 0 = main item)
+function dependencyParents(rand, n, maxFanOut) {
+  const parents = []
+  while (parents.length < n) {
+    const main = parents.length + 1
+    parents.push(0)
+    const fanOut = rand.int(0, maxFanOut)
+    for (let a = 0; a < fanOut && parents.length < n; a++) parents.push(main)
+  }
+  return parents
+}
+
+/**
+ * Build argv for one instance.
+ * Algorithm-specific extras follow each solver's command line format.
+ */
+export function generateInstance(algorithm, cls, n, capacity, seed, R = 100) {
+  const rand = createRandom(seed)
+  const items = pisingerItems(rand, cls, n, R)
+  const head = [capacity.toString()]
+  let body
+
+  switch (algorithm) {
+    case 'knapsack_multiple':
+      body = items.map(({ w, v }) => `${w},${v},${rand.int(1, 10)}`)
+      break
+    case 'knapsack_mixed':
+      body = items.map(({ w, v }) => `${w},${v},${rand.int(0, 2)}`)
+      break
+    case 'knapsack_2d':
+    case 'knapsack_2d_parallel': {
+      head.push(capacity.toString())
+      body = items.map(({ w, v }) => `${w},${rand.int(1, R)},${v}`)
+      break
+    }
+    case 'knapsack_nd': {
+      // Three limits: the capacity twice more, with its own random cost per limit
+      head.push(capacity.toString(), capacity.toString())
+      body = items.map(({ w, v }) => `${w},${rand.int(1, R)},${rand.int(1, R)},${v}`)
+      break
+    }
+    case 'knapsack_group': {
+      const groupSize = 4
+      body = items.map(({ w, v }, i) => `${w},${v},${Math.floor(i / groupSize) + 1}`)
+      break
+    }
+    case 'knapsack_tree':
+    case 'knapsack_tree_parallel': {
+      const parents = treeParents(rand, n)
+      body = items.map(({ w, v }, i) => `${w},${v},${parents[i]}`)
+      break
+    }
+    case 'knapsack_depend': {
+      const parents = dependencyParents(rand, n, 2)
+      body = items.map(({ w, v }, i) => `${w},${v},${parents[i]}`)
+      break
+    }
+    case 'knapsack_kth':
+      head.push('5')
+      body = items.map(({ w, v }) => `${w},${v}`)
+      break
+    case 'knapsack_fptas':
+      head.push('0.1')
+      body = items.map(({ w, v }) => `${w},${v}`)
+      break
+    case 'knapsack_rolling':
+      head.push('complete')
+      body = items.map(({ w, v }) => `${w},${v}`)
+      break
+    case 'knapsack_value':
+      head.push('01')
+      body = items.map(({ w, v }) => `${w},${v}`)
+      break
+    default:
+      body = items.map(({ w, v }) => `${w},${v}`)
+  }
+
+  return [...head, n.toString(), ...body]
+}
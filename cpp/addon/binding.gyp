@@ -0,0 +1,21 @@
+{
+  "targets": [
+    {
+      "target_name": "knapsack",
+      "sources": ["knapsack_addon.cpp", "../knapsack_lib.cpp"],
+      "defines": ["KNAPSACK_STATIC", "NAPI_VERSION=8"],
+      "cflags_cc": ["-std=c++17", "-O2", "-fexceptions"],
+      "cflags_cc!": ["-fno-exceptions", "-fno-rtti"],
+      "xcode_settings": {
+        "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+        "CLANG_CXX_LANGUAGE_STANDARD": "c++17"
+      },
+      "msvs_settings": {
+        "VCCLCompilerTool": {"ExceptionHandling": 1, "AdditionalOptions": ["/std:c++17"]}
+      },
+      "conditions": [
+        ["OS=='win'", {"libraries": ["-lpsapi"]}]
+      ]
+    }
+  ]
+}
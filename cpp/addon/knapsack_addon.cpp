@@ -0,0 +1,183 @@
+/**
+ * Node Addon for the Solver Library
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description N-API binding of knapsack_api.h for the Electron main process. solve() queues the run on
+ *              the libuv thread pool and returns at once with a promise and a cancel function:
+ *                const { promise, cancel } = addon.solve('knapsack_01', ['knapsack_01', '10', '3', ...])
+ *              The promise resolves to an ArrayBuffer holding the solver's JSON output, handed over without
+ *              a copy where the runtime allows external buffers. It rejects with an Error whose code is
+ *              INVALID (message is the solver's error JSON), UNKNOWN_ALGORITHM, CANCELLED or FAILED
+ *
+ * Build: node-gyp rebuild (or electron-rebuild) in this directory
+ */
+
+#include <node_api.h>
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../knapsack_api.h"
+
+namespace knapsack_addon {
+
+// Shared by the worker and the cancel function; freed once both are done with it
+struct Job {
+    napi_async_work work = nullptr;
+    napi_deferred deferred = nullptr;
+    std::string algorithm;
+    std::vector<std::string> args;
+    knapsack_cancel_token* token = nullptr;
+    knapsack_result* result = nullptr;
+    int status = KNAPSACK_FAILED;
+    std::atomic<int> refs{2};
+};
+
+void release(Job* job) {
+    if (job->refs.fetch_sub(1) == 1) {
+        knapsack_result_free(job->result);
+        knapsack_cancel_token_free(job->token);
+        delete job;
+    }
+}
+
+bool readString(napi_env env, napi_value value, std::string& out) {
+    size_t length = 0;
+    if (napi_get_value_string_utf8(env, value, nullptr, 0, &length) != napi_ok) return false;
+    out.resize(length + 1);
+    napi_get_value_string_utf8(env, value, &out[0], length + 1, &length);
+    out.resize(length);
+    return true;
+}
+
+napi_value throwType(napi_env env, const char* message) {
+    napi_throw_type_error(env, nullptr, message);
+    return nullptr;
+}
+
+const char* statusCode(int status) {
+    switch (status) {
+        case KNAPSACK_INVALID: return "INVALID";
+        case KNAPSACK_UNKNOWN_ALGORITHM: return "UNKNOWN_ALGORITHM";
+        case KNAPSACK_CANCELLED: return "CANCELLED";
+        default: return "FAILED";
+    }
+}
+
+// Runs on a libuv worker thread: no N-API calls here
+void execute(napi_env, void* data) {
+    Job* job = static_cast<Job*>(data);
+    std::vector<const char*> argv;
+    for (const std::string& a : job->args) argv.push_back(a.c_str());
+    job->status = knapsack_solve(job->algorithm.c_str(), (int)argv.size(), argv.data(), job->token, &job->result);
+}
+
+void freeResult(napi_env, void*, void* hint) { knapsack_result_free(static_cast<knapsack_result*>(hint)); }
+
+void complete(napi_env env, napi_status, void* data) {
+    Job* job = static_cast<Job*>(data);
+    size_t length = 0;
+    const char* bytes = knapsack_result_data(job->result, &length);
+
+    if (job->status == KNAPSACK_OK) {
+        napi_value buffer;
+        if (napi_create_external_arraybuffer(env, const_cast<char*>(bytes), length, freeResult, job->result,
+                                             &buffer) == napi_ok) {
+            job->result = nullptr;  // Now owned by the ArrayBuffer
+        } else {
+            // Electron's V8 memory cage refuses external memory: copy instead
+            void* copy = nullptr;
+            napi_create_arraybuffer(env, length, &copy, &buffer);
+            if (length) std::memcpy(copy, bytes, length);
+        }
+        napi_resolve_deferred(env, job->deferred, buffer);
+    } else {
+        napi_value code, message, error;
+        napi_create_string_utf8(env, statusCode(job->status), NAPI_AUTO_LENGTH, &code);
+        if (job->status == KNAPSACK_INVALID) {
+            napi_create_string_utf8(env, bytes, length, &message);
+        } else {
+            std::string text = std::string("Solver ") + job->algorithm + ": " + statusCode(job->status);
+            napi_create_string_utf8(env, text.c_str(), text.size(), &message);
+        }
+        napi_create_error(env, code, message, &error);
+        napi_reject_deferred(env, job->deferred, error);
+    }
+
+    napi_delete_async_work(env, job->work);
+    release(job);
+}
+
+napi_value cancel(napi_env env, napi_callback_info info) {
+    void* data = nullptr;
+    napi_get_cb_info(env, info, nullptr, nullptr, nullptr, &data);
+    knapsack_cancel(static_cast<Job*>(data)->token);
+    return nullptr;
+}
+
+void releaseCancel(napi_env, void* data, void*) { release(static_cast<Job*>(data)); }
+
+// solve(algorithm: string, args: string[]) -> { promise: Promise<ArrayBuffer>, cancel: () => void }
+napi_value solve(napi_env env, napi_callback_info info) {
+    size_t argc = 2;
+    napi_value argv[2];
+    napi_get_cb_info(env, info, &argc, argv, nullptr, nullptr);
+    if (argc < 2) return throwType(env, "solve(algorithm, args) expects two arguments");
+
+    Job* job = new Job();
+    bool isArray = false;
+    uint32_t count = 0;
+    if (!readString(env, argv[0], job->algorithm) || napi_is_array(env, argv[1], &isArray) != napi_ok ||
+        !isArray) {
+        delete job;
+        return throwType(env, "algorithm must be a string and args an array of strings");
+    }
+    napi_get_array_length(env, argv[1], &count);
+    job->args.resize(count);
+    for (uint32_t i = 0; i < count; i++) {
+        napi_value element;
+        napi_get_element(env, argv[1], i, &element);
+        if (!readString(env, element, job->args[i])) {
+            delete job;
+            return throwType(env, "args must contain only strings");
+        }
+    }
+    job->token = knapsack_cancel_token_create();
+
+    napi_value promise, resource, cancelFn, handle;
+    napi_create_promise(env, &job->deferred, &promise);
+    napi_create_string_utf8(env, "knapsack:solve", NAPI_AUTO_LENGTH, &resource);
+    napi_create_async_work(env, nullptr, resource, execute, complete, job, &job->work);
+
+    napi_create_function(env, "cancel", NAPI_AUTO_LENGTH, cancel, job, &cancelFn);
+    napi_add_finalizer(env, cancelFn, job, releaseCancel, nullptr, nullptr);
+
+    napi_queue_async_work(env, job->work);
+
+    napi_create_object(env, &handle);
+    napi_set_named_property(env, handle, "promise", promise);
+    napi_set_named_property(env, handle, "cancel", cancelFn);
+    return handle;
+}
+
+napi_value abiVersion(napi_env env, napi_callback_info) {
+    napi_value version;
+    napi_create_int32(env, knapsack_abi_version(), &version);
+    return version;
+}
+
+napi_value init(napi_env env, napi_value exports) {
+    napi_property_descriptor properties[] = {
+        {"solve", nullptr, solve, nullptr, nullptr, nullptr, napi_default, nullptr},
+        {"abiVersion", nullptr, abiVersion, nullptr, nullptr, nullptr, napi_default, nullptr},
+    };
+    napi_define_properties(env, exports, 2, properties);
+    return exports;
+}
+
+}  // namespace knapsack_addon
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, knapsack_addon::init)
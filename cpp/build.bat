@@ -1,35 +1,77 @@
 @echo off
 echo Compiling all knapsack algorithms...
 
-g++ -o knapsack_01.exe knapsack_01.cpp -std=c++17 -O2
+g++ -o knapsack_01.exe knapsack_01.cpp -std=c++17 -O2 -lpsapi
 if %errorlevel% neq 0 echo Failed: knapsack_01
 
-g++ -o knapsack_complete.exe knapsack_complete.cpp -std=c++17 -O2
+g++ -o knapsack_complete.exe knapsack_complete.cpp -std=c++17 -O2 -lpsapi
 if %errorlevel% neq 0 echo Failed: knapsack_complete
 
-g++ -o knapsack_multiple.exe knapsack_multiple.cpp -std=c++17 -O2
+g++ -o knapsack_multiple.exe knapsack_multiple.cpp -std=c++17 -O2 -lpsapi
 if %errorlevel% neq 0 echo Failed: knapsack_multiple
 
-g++ -o knapsack_mixed.exe knapsack_mixed.cpp -std=c++17 -O2
+g++ -o knapsack_mixed.exe knapsack_mixed.cpp -std=c++17 -O2 -lpsapi
 if %errorlevel% neq 0 echo Failed: knapsack_mixed
 
-g++ -o knapsack_2d.exe knapsack_2d.cpp -std=c++17 -O2
+g++ -o knapsack_2d.exe knapsack_2d.cpp -std=c++17 -O2 -lpsapi
 if %errorlevel% neq 0 echo Failed: knapsack_2d
 
-g++ -o knapsack_group.exe knapsack_group.cpp -std=c++17 -O2
+g++ -o knapsack_nd.exe knapsack_nd.cpp -std=c++17 -O2 -lpsapi
+if %errorlevel% neq 0 echo Failed: knapsack_nd
+
+g++ -o knapsack_2d_parallel.exe knapsack_2d_parallel.cpp -std=c++17 -O2 -pthread -lpsapi
+if %errorlevel% neq 0 echo Failed: knapsack_2d_parallel
+
+g++ -o knapsack_group.exe knapsack_group.cpp -std=c++17 -O2 -lpsapi
 if %errorlevel% neq 0 echo Failed: knapsack_group
 
-g++ -o knapsack_depend.exe knapsack_depend.cpp -std=c++17 -O2
+g++ -o knapsack_depend.exe knapsack_depend.cpp -std=c++17 -O2 -lpsapi
 if %errorlevel% neq 0 echo Failed: knapsack_depend
 
-g++ -o knapsack_tree.exe knapsack_tree.cpp -std=c++17 -O2
+g++ -o knapsack_tree.exe knapsack_tree.cpp -std=c++17 -O2 -lpsapi
 if %errorlevel% neq 0 echo Failed: knapsack_tree
 
-g++ -o knapsack_kth.exe knapsack_kth.cpp -std=c++17 -O2
+g++ -o knapsack_tree_parallel.exe knapsack_tree_parallel.cpp -std=c++17 -O2 -pthread -lpsapi
+if %errorlevel% neq 0 echo Failed: knapsack_tree_parallel
+
+g++ -o knapsack_kth.exe knapsack_kth.cpp -std=c++17 -O2 -lpsapi
 if %errorlevel% neq 0 echo Failed: knapsack_kth
 
-g++ -o knapsack_count.exe knapsack_count.cpp -std=c++17 -O2
+g++ -o knapsack_count.exe knapsack_count.cpp -std=c++17 -O2 -lpsapi
 if %errorlevel% neq 0 echo Failed: knapsack_count
 
+g++ -o knapsack_mitm.exe knapsack_mitm.cpp -std=c++17 -O2 -pthread -lpsapi
+if %errorlevel% neq 0 echo Failed: knapsack_mitm
+
+g++ -o knapsack_unbounded.exe knapsack_unbounded.cpp -std=c++17 -O2 -lpsapi
+if %errorlevel% neq 0 echo Failed: knapsack_unbounded
+
+g++ -o knapsack_rolling.exe knapsack_rolling.cpp -std=c++17 -O2 -lpsapi
+if %errorlevel% neq 0 echo Failed: knapsack_rolling
+
+g++ -o knapsack_fptas.exe knapsack_fptas.cpp -std=c++17 -O2 -lpsapi
+if %errorlevel% neq 0 echo Failed: knapsack_fptas
+
+g++ -o knapsack_value.exe knapsack_value.cpp -std=c++17 -O2 -lpsapi
+if %errorlevel% neq 0 echo Failed: knapsack_value
+
+g++ -o knapsack_dynamic.exe knapsack_dynamic.cpp -std=c++17 -O2 -lpsapi
+if %errorlevel% neq 0 echo Failed: knapsack_dynamic
+
+g++ -o knapsack_batch.exe knapsack_batch.cpp -std=c++17 -O2 -pthread -lpsapi
+if %errorlevel% neq 0 echo Failed: knapsack_batch
+
+g++ -o knapsack_session.exe knapsack_session.cpp -std=c++17 -O2 -lpsapi
+if %errorlevel% neq 0 echo Failed: knapsack_session
+
+g++ -o knapsack_stream.exe knapsack_stream.cpp -std=c++17 -O2 -lpsapi
+if %errorlevel% neq 0 echo Failed: knapsack_stream
+
+g++ -o knapsack_table.exe knapsack_table.cpp -std=c++17 -O2 -lpsapi
+if %errorlevel% neq 0 echo Failed: knapsack_table
+
+g++ -shared -o knapsack.dll knapsack_lib.cpp -std=c++17 -O2 -pthread -DKNAPSACK_BUILD_DLL -lpsapi
+if %errorlevel% neq 0 echo Failed: knapsack_lib
+
 echo Done!
 dir *.exe
@@ -0,0 +1,29 @@
+#!/bin/sh
+# Build all knapsack algorithms (Linux / macOS). The hot kernels pick their ISA variant at startup
+# (knapsack_kernels.h), so the binaries need no -march and run on any x86-64 host
+cd "$(dirname "$0")"
+echo "Compiling all knapsack algorithms..."
+
+CXXFLAGS="-std=c++17 -O2 -pthread"
+failed=0
+
+for src in knapsack_*.cpp; do
+    name="${src%.cpp}"
+    [ "$name" = knapsack_lib ] && continue
+    if ! g++ -o "$name" "$src" $CXXFLAGS; then
+        echo "Failed: $name"
+        failed=1
+    fi
+done
+
+# Solver library (knapsack_api.h)
+lib=libknapsack.so
+[ "$(uname)" = Darwin ] && lib=libknapsack.dylib
+if ! g++ -shared -fPIC -o "$lib" knapsack_lib.cpp $CXXFLAGS; then
+    echo "Failed: knapsack_lib"
+    failed=1
+fi
+
+echo "Done!"
+ls -l knapsack_* "$lib" | grep -v '\.\(cpp\|h\)$'
+exit $failed
@@ -3,7 +3,8 @@
  * 
  * @author Cyans
  * @affiliation Chang'an University
- * @description Dynamic programming solution for 0/1 knapsack problem where each item can be selected at most once
+ * @description Dynamic programming solution for 0/1 knapsack problem where each item can be selected at most once.
+ *              The table's cell type is the narrowest one that holds the total value (knapsack_cells.h)
  * 
  * Input: Command line arguments in JSON format
  * Output: Standard output in JSON format (including animation steps)
@@ -15,13 +16,23 @@
 #include <sstream>
 #include <algorithm>
 #include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_keyframes.h"
+#include "knapsack_trace_codec.h"
+#include "row_store.h"
+#include "knapsack_kernels.h"
+#include "knapsack_cells.h"
 
 using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_01 {
 
 // Simple JSON parsing
 struct Item {
     int weight;
-    int value;
+    long long value;
 };
 
 // JSON output builder (manual concatenation to avoid third-party libraries)
@@ -32,9 +43,9 @@ private:
     
 public:
     void startObject() { ss << "{"; firstItem = true; }
-    void endObject() { ss << "}"; }
+    void endObject() { ss << "}"; firstItem = false; }
     void startArray() { ss << "["; firstItem = true; }
-    void endArray() { ss << "]"; }
+    void endArray() { ss << "]"; firstItem = false; }
     
     void key(const string& k) {
         if (!firstItem) ss << ",";
@@ -43,8 +54,12 @@ public:
     }
     
     void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
     void value(const string& v) { ss << "\"" << v << "\""; }
     void value(double v) { ss << v; }
+    void raw(const string& v) { ss << v; }
+    template <class T>
+    void cell(T v) { knapsack_cells::write(ss, v); }
     
     void nextItem() {
         if (!firstItem) ss << ",";
@@ -54,32 +69,17 @@ public:
     string str() { return ss.str(); }
 };
 
-int main(int argc, char* argv[]) {
-    // Start timing
-    auto startTime = chrono::high_resolution_clock::now();
-    
-    // Parse input arguments
-    // Format: knapsack_01.exe <capacity> <n> <w1,v1> <w2,v2> ...
-    if (argc < 3) {
-        cout << R"({"code":400,"error":"Insufficient parameters"})";
-        return 1;
-    }
-    
-    int capacity = stoi(argv[1]);
-    int n = stoi(argv[2]);
+// The DP for one cell type T, which holds every value the table can reach
+template <class T>
+int solve(int capacity, const vector<Item>& items, int argc, char* argv[], Profiler& profiler,
+          chrono::high_resolution_clock::time_point startTime, ostream& out) {
+    int n = items.size();
     
-    vector<Item> items(n);
-    for (int i = 0; i < n && i + 3 < argc; i++) {
-        string arg = argv[i + 3];
-        size_t comma = arg.find(',');
-        items[i].weight = stoi(arg.substr(0, comma));
-        items[i].value = stoi(arg.substr(comma + 1));
-    }
-    
-    // DP array
-    vector<vector<int>> dp(n + 1, vector<int>(capacity + 1, 0));
+    // DP table, in memory or in a mapped file (row_store.h)
+    knapsack_rows::RowStore<T> dp(n + 1, capacity + 1, "knapsack_01");
     
     // Start building JSON
+    profiler.enter(SERIALIZE);
     JsonBuilder json;
     json.startObject();
     
@@ -99,50 +99,61 @@ int main(int argc, char* argv[]) {
     }
     json.endArray();
     
+    OpCounters ops;  // Work done by the DP kernel
+    const knapsack_kernels::RowKernels<T>& kernels = knapsack_kernels::rowKernels<T>();  // Widest ISA of this host
+    profiler.setKernel(kernels.name);
+    
+    // With --trace=packed the rows are delta-encoded instead of written as steps (knapsack_trace_codec.h),
+    // with --trace=none there are no steps at all
+    const bool packed = knapsack_trace::packedRequested(argc, argv);
+    const bool omitted = !packed && knapsack_trace::stepsOmitted(argc, argv);
+    knapsack_trace::DeltaEncoder trace(capacity + 1, "row");
+    if (packed) trace.row<T>(nullptr, dp[0]);  // Row 0 first: the base of row 1
+    knapsack_trace::KeyframeRecorder<T> keyframes(packed || omitted ? 0 : n + 1, capacity + 1);
+    
     // Animation steps
-    json.key("steps");
-    json.startArray();
+    if (!packed && !omitted) {
+        json.key("steps");
+        json.startArray();
+    }
     
-    // DP calculation process
+    // DP calculation process: compute each row, then emit its animation steps
     for (int i = 1; i <= n; i++) {
         int w = items[i - 1].weight;
-        int v = items[i - 1].value;
+        T v = (T)items[i - 1].value;
+        
+        // Skip everywhere, take where it fits: dp[i][j] = max(dp[i-1][j], dp[i-1][j-w] + v)
+        profiler.enter(DP);
+        kernels.rowUpdate(dp[i - 1], dp[i], capacity + 1, w, v);
         
+        dp.rowDone(i);
+        
+        ops.cells += capacity + 1;
+        ops.candidates += capacity + 1 + max(0, capacity - w + 1);  // Skip everywhere, take where it fits
+        
+        profiler.enter(SERIALIZE);
+        if (packed) {
+            trace.row(dp[i - 1], dp[i]);
+            continue;
+        }
+        if (omitted) continue;
         for (int j = 0; j <= capacity; j++) {
             json.nextItem();
             json.startObject();
             json.key("row"); json.value(i);
             json.key("col"); json.value(j);
-            
-            if (j < w) {
-                // Cannot fit, inherit from previous row
-                dp[i][j] = dp[i - 1][j];
-                json.key("val"); json.value(dp[i][j]);
-                json.key("highlight");
-                json.startArray();
-                json.nextItem();
-                json.startObject();
-                json.key("r"); json.value(i - 1);
-                json.key("c"); json.value(j);
-                json.key("type"); json.value("without");
-                json.endObject();
-                json.endArray();
-            } else {
-                // Can choose to take or skip
-                int withoutItem = dp[i - 1][j];
-                int withItem = dp[i - 1][j - w] + v;
-                dp[i][j] = max(withoutItem, withItem);
-                
-                json.key("val"); json.value(dp[i][j]);
-                json.key("highlight");
-                json.startArray();
-                // Skip
-                json.nextItem();
-                json.startObject();
-                json.key("r"); json.value(i - 1);
-                json.key("c"); json.value(j);
-                json.key("type"); json.value("without");
-                json.endObject();
+            json.key("val"); json.cell(dp[i][j]);
+            keyframes.step(i, j, dp[i][j]);
+            json.key("highlight");
+            json.startArray();
+            // Skip
+            json.nextItem();
+            json.startObject();
+            json.key("r"); json.value(i - 1);
+            json.key("c"); json.value(j);
+            json.key("type"); json.value("without");
+            json.endObject();
+            if (j >= w) {
                 // Take
                 json.nextItem();
                 json.startObject();
@@ -150,8 +161,8 @@ int main(int argc, char* argv[]) {
                 json.key("c"); json.value(j - w);
                 json.key("type"); json.value("with");
                 json.endObject();
-                json.endArray();
             }
+            json.endArray();
             
             json.key("decision"); 
             json.value(dp[i][j] == dp[i-1][j] ? "skip" : "take");
@@ -159,27 +170,43 @@ int main(int argc, char* argv[]) {
             json.endObject();
         }
     }
-    json.endArray();
+    if (packed) {
+        json.key("trace"); json.raw(trace.json());
+    } else if (!omitted) {
+        json.endArray();
+        json.key("keyframes"); json.raw(keyframes.json());
+    }
+    
+    profiler.setDpCells(ops.cells);
     
     // Backtrack path
-    json.key("path");
-    json.startArray();
+    profiler.enter(RECONSTRUCT);
+    vector<pair<int, int>> path;  // (row, col) of each taken item
     int j = capacity;
     for (int i = n; i > 0 && j > 0; i--) {
+        dp.reading(i - 1);
         if (dp[i][j] != dp[i - 1][j]) {
-            json.nextItem();
-            json.startObject();
-            json.key("r"); json.value(i);
-            json.key("c"); json.value(j);
-            json.key("item"); json.value(i - 1);
-            json.endObject();
+            path.push_back({i, j});
             j -= items[i - 1].weight;
         }
     }
+    
+    profiler.enter(SERIALIZE);
+    json.key("path");
+    json.startArray();
+    for (auto& [r, c] : path) {
+        json.nextItem();
+        json.startObject();
+        json.key("r"); json.value(r);
+        json.key("c"); json.value(c);
+        json.key("item"); json.value(r - 1);
+        json.endObject();
+    }
     json.endArray();
     
     // Final result
-    json.key("max_value"); json.value(dp[n][capacity]);
+    json.key("max_value"); json.cell(dp[n][capacity]);
+    json.key("cell_type"); json.value(knapsack_cells::name<T>());
     
     // End timing
     auto endTime = chrono::high_resolution_clock::now();
@@ -191,16 +218,67 @@ int main(int argc, char* argv[]) {
     json.startObject();
     json.key("time"); json.value("O(n*C)");
     json.key("space"); json.value("O(n*C)");
-    json.key("operations"); json.value(n * (capacity + 1));
-    json.key("memory_bytes"); json.value((n + 1) * (capacity + 1) * 4);
-    json.endObject();
-    
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((long long)(n + 1) * (capacity + 1) * (long long)sizeof(T));
     json.endObject();
+    if (dp.mapped()) {
+        json.key("row_store"); json.raw(dp.json());
+    }
     
-    cout << json.str();
+    // The root object stays open: the profile is appended after the body has been written
+    writeResult(json.str(), profiler, out);
     
     return 0;
 }
 
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
+    
+    // Start timing
+    auto startTime = chrono::high_resolution_clock::now();
+    
+    // Parse input arguments
+    // Format: knapsack_01.exe <capacity> <n> <w1,v1> <w2,v2> ...
+    if (argc < 3) {
+        out << R"({"code":400,"error":"Insufficient parameters"})";
+        return 1;
+    }
+    
+    int capacity = stoi(argv[1]);
+    int n = stoi(argv[2]);
+    
+    vector<Item> items(n);
+    for (int i = 0; i < n && i + 3 < argc; i++) {
+        string arg = argv[i + 3];
+        size_t comma = arg.find(',');
+        items[i].weight = stoi(arg.substr(0, comma));
+        items[i].value = stoll(arg.substr(comma + 1));
+    }
+    
+    // Every cell and every candidate dp[i-1][j-w] + v stays within the sum of |v|
+    profiler.enter(PREPROCESS);
+    knapsack_cells::int128 bound = 0;
+    bool negative = false;
+    for (const Item& item : items) {
+        bound += item.value < 0 ? -(knapsack_cells::int128)item.value : item.value;
+        negative = negative || item.value < 0;
+    }
+    return knapsack_cells::dispatch(bound, negative, [&](auto zero) {
+        return solve<decltype(zero)>(capacity, items, argc, argv, profiler, startTime, out);
+    });
+}
+
+}  // namespace knapsack_01
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_01", knapsack_01::run, argc, argv, cout);
+}
+#endif
+
 
 
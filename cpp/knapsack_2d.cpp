@@ -11,9 +11,16 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <climits>
 #include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_cells.h"
 
 using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_2d {
 
 struct Item {
     int weight;
@@ -27,15 +34,16 @@ private:
     bool firstItem = true;
 public:
     void startObject() { ss << "{"; firstItem = true; }
-    void endObject() { ss << "}"; }
+    void endObject() { ss << "}"; firstItem = false; }
     void startArray() { ss << "["; firstItem = true; }
-    void endArray() { ss << "]"; }
+    void endArray() { ss << "]"; firstItem = false; }
     void key(const string& k) {
         if (!firstItem) ss << ",";
         ss << "\"" << k << "\":";
         firstItem = false;
     }
     void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
     void value(const string& v) { ss << "\"" << v << "\""; }
     void value(double v) { ss << v; }
     void nextItem() {
@@ -45,11 +53,12 @@ public:
     string str() { return ss.str(); }
 };
 
-int main(int argc, char* argv[]) {
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
     auto startTime = chrono::high_resolution_clock::now();
     
     if (argc < 4) {
-        cout << R"({"code":400,"error":"Insufficient parameters"})";
+        out << R"({"code":400,"error":"Insufficient parameters"})";
         return 1;
     }
     
@@ -67,12 +76,22 @@ int main(int argc, char* argv[]) {
         items[i].value = stoi(arg.substr(comma2 + 1));
     }
     
+    // Every cell of the int table is a subset's value, within the sum of |v|
+    knapsack_cells::int128 bound = 0;
+    for (const Item& item : items) bound += knapsack_cells::magnitude(item.value);
+    if (bound > INT_MAX) {
+        out << R"({"code":400,"error":"Total value exceeds the int range of the DP"})";
+        return 1;
+    }
+    
     // 3D DP: dp[i][j][k] = max value with first i items, weight <= j, volume <= k
     // For visualization, we show 2D slices at fixed volume
+    profiler.enter(PREPROCESS);
     vector<vector<vector<int>>> dp(n + 1, 
         vector<vector<int>>(capacity + 1, 
             vector<int>(capacity2 + 1, 0)));
     
+    profiler.enter(SERIALIZE);
     JsonBuilder json;
     json.startObject();
     json.key("code"); json.value(200);
@@ -92,29 +111,37 @@ int main(int argc, char* argv[]) {
     }
     json.endArray();
     
+    OpCounters ops;  // Work done by the DP kernel
+    
     json.key("steps");
     json.startArray();
     
-    // DP calculation (record steps for all volume dimensions for visualization)
+    // DP calculation (record steps for all volume dimensions for visualization);
+    // compute each item's plane, then emit its steps
     for (int i = 1; i <= n; i++) {
         int w = items[i - 1].weight;
         int m = items[i - 1].volume;
         int v = items[i - 1].value;
         
+        profiler.enter(DP);
         for (int j = 0; j <= capacity; j++) {
             for (int k = 0; k <= capacity2; k++) {
-                int oldVal = dp[i - 1][j][k];
-                int newVal = oldVal;
-                bool took = false;
-                
+                int newVal = dp[i - 1][j][k];
                 if (j >= w && k >= m) {
-                    int withItem = dp[i - 1][j - w][k - m] + v;
-                    if (withItem > newVal) {
-                        newVal = withItem;
-                        took = true;
-                    }
+                    newVal = max(newVal, dp[i - 1][j - w][k - m] + v);
                 }
                 dp[i][j][k] = newVal;
+            }
+        }
+        
+        ops.cells += (long long)(capacity + 1) * (capacity2 + 1);
+        ops.candidates += (long long)(capacity + 1) * (capacity2 + 1) +
+                          (long long)max(0, capacity - w + 1) * max(0, capacity2 - m + 1);
+        
+        profiler.enter(SERIALIZE);
+        for (int j = 0; j <= capacity; j++) {
+            for (int k = 0; k <= capacity2; k++) {
+                bool took = dp[i][j][k] != dp[i - 1][j][k];
                 
                 // Record steps for each volume slice
                 json.nextItem();
@@ -152,21 +179,28 @@ int main(int argc, char* argv[]) {
     json.endArray();
     
     // Backtrack
-    json.key("path");
-    json.startArray();
+    profiler.enter(RECONSTRUCT);
+    vector<pair<int, int>> path;  // (row, weight column) of each taken item
     int j = capacity, k = capacity2;
     for (int i = n; i > 0 && j > 0 && k > 0; i--) {
         if (dp[i][j][k] != dp[i - 1][j][k]) {
-            json.nextItem();
-            json.startObject();
-            json.key("r"); json.value(i);
-            json.key("c"); json.value(j);
-            json.key("item"); json.value(i - 1);
-            json.endObject();
+            path.push_back({i, j});
             j -= items[i - 1].weight;
             k -= items[i - 1].volume;
         }
     }
+    
+    profiler.enter(SERIALIZE);
+    json.key("path");
+    json.startArray();
+    for (auto& [r, c] : path) {
+        json.nextItem();
+        json.startObject();
+        json.key("r"); json.value(r);
+        json.key("c"); json.value(c);
+        json.key("item"); json.value(r - 1);
+        json.endObject();
+    }
     json.endArray();
     
     json.key("max_value"); json.value(dp[n][capacity][capacity2]);
@@ -179,15 +213,27 @@ int main(int argc, char* argv[]) {
     json.startObject();
     json.key("time"); json.value("O(n*C*M)");
     json.key("space"); json.value("O(n*C*M)");
-    json.key("operations"); json.value(n * (capacity + 1) * (capacity2 + 1));
-    json.key("memory_bytes"); json.value((n + 1) * (capacity + 1) * (capacity2 + 1) * 4);
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((long long)(n + 1) * (capacity + 1) * (capacity2 + 1) * 4);
     json.endObject();
     
-    json.endObject();
-    cout << json.str();
+    // The root object stays open: the profile is appended after the body has been written
+    writeResult(json.str(), profiler, out);
     return 0;
 }
 
+}  // namespace knapsack_2d
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_2d", knapsack_2d::run, argc, argv, cout);
+}
+#endif
+
 
 
 
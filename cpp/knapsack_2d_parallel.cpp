@@ -0,0 +1,361 @@
+/**
+ * 2D Cost Knapsack Algorithm (Parallel, Solve Only)
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Two-dimensional cost knapsack on several threads. For each item the (j, k) plane depends only on
+ *              the previous item's plane, so every weight slice j can be computed on its own: the slices are cut
+ *              into one band (tile) per worker, each worker keeps its band for the whole run, and the workers
+ *              meet at one barrier per item before the two planes swap. Instead of knapsack_2d's n + 1 planes
+ *              only two are kept, plus one decision bit per item and cell for the backtrack.
+ *              Ownership is NUMA-aware: on a machine with several nodes the workers are pinned in node order
+ *              (Linux, /sys/devices/system/node), so neighbouring bands, which read each other's slices, share
+ *              a node; and every worker is the first to touch its own slices of both planes and of the bits,
+ *              which places those pages on its node
+ *
+ * Input: Command line arguments, same as knapsack_2d, optionally followed by --threads N
+ * Output: Standard output in JSON format (no animation steps)
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <climits>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_cells.h"
+#include "knapsack_kernels.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_2d_parallel {
+
+struct Item {
+    int weight;
+    int volume;
+    int value;
+};
+
+class JsonBuilder {
+private:
+    stringstream ss;
+    bool firstItem = true;
+
+public:
+    void startObject() { ss << "{"; firstItem = true; }
+    void endObject() { ss << "}"; firstItem = false; }
+    void startArray() { ss << "["; firstItem = true; }
+    void endArray() { ss << "]"; firstItem = false; }
+
+    void key(const string& k) {
+        if (!firstItem) ss << ",";
+        ss << "\"" << k << "\":";
+        firstItem = false;
+    }
+
+    void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
+    void value(const string& v) { ss << "\"" << v << "\""; }
+    void value(double v) { ss << v; }
+    void value(bool v) { ss << (v ? "true" : "false"); }
+
+    void nextItem() {
+        if (!firstItem) ss << ",";
+        firstItem = false;
+    }
+
+    string str() { return ss.str(); }
+};
+
+// Reusable barrier for a fixed set of threads. Waiters spin briefly and then yield, so more workers than
+// cores still make progress
+class SpinBarrier {
+private:
+    const int total;
+    atomic<int> arrived{0};
+    atomic<long long> generation{0};
+
+public:
+    explicit SpinBarrier(int total) : total(total) {}
+
+    void wait() {
+        long long gen = generation.load(memory_order_acquire);
+        if (arrived.fetch_add(1, memory_order_acq_rel) + 1 == total) {
+            arrived.store(0, memory_order_relaxed);
+            generation.fetch_add(1, memory_order_release);
+            return;
+        }
+        for (int spins = 0; generation.load(memory_order_acquire) == gen; spins++) {
+            if (spins >= 1024) this_thread::yield();
+        }
+    }
+};
+
+// CPUs this process may run on, grouped by NUMA node in node order; nodes = number of nodes seen
+vector<int> cpusByNode(int& nodes) {
+    vector<int> order;
+    nodes = 1;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return order;
+    int seen = 0;
+    for (int node = 0; node < 1024; node++) {
+        ifstream list("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+        if (!list) {
+            if (seen > 0 || node > 64) break;  // Node ids may start above 0, but not far above
+            continue;
+        }
+        seen++;
+        // Ranges like "0-3,8-11"
+        string range;
+        while (getline(list, range, ',')) {
+            size_t dash = range.find('-');
+            int first = stoi(range.substr(0, dash));
+            int last = dash == string::npos ? first : stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++) {
+                if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) order.push_back(cpu);
+            }
+        }
+    }
+    nodes = max(1, seen);
+#endif
+    return order;
+}
+
+// Pin the calling thread; a worker does this itself before it touches any memory, so its first-touch pages
+// are placed on the node it will run on
+void pinSelf(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
+    auto startTime = chrono::high_resolution_clock::now();
+
+    // Format: knapsack_2d_parallel.exe <capacity> <capacity2> <n> <w1,m1,v1> ... [--threads N]
+    if (argc < 4) {
+        out << R"({"code":400,"error":"Insufficient parameters"})";
+        return 1;
+    }
+
+    int capacity = stoi(argv[1]);   // Weight limit
+    int capacity2 = stoi(argv[2]);  // Volume limit
+    int n = stoi(argv[3]);
+
+    vector<Item> items(n);
+    for (int i = 0; i < n && i + 4 < argc; i++) {
+        string arg = argv[i + 4];
+        size_t comma1 = arg.find(',');
+        size_t comma2 = arg.find(',', comma1 + 1);
+        items[i].weight = stoi(arg.substr(0, comma1));
+        items[i].volume = stoi(arg.substr(comma1 + 1, comma2 - comma1 - 1));
+        items[i].value = stoi(arg.substr(comma2 + 1));
+    }
+
+    // Every cell of the int plane is a subset's value, within the sum of |v|
+    knapsack_cells::int128 bound = 0;
+    for (const Item& item : items) bound += knapsack_cells::magnitude(item.value);
+    if (bound > INT_MAX) {
+        out << R"({"code":400,"error":"Total value exceeds the int range of the DP"})";
+        return 1;
+    }
+
+    int rows = capacity + 1;
+    int cols = capacity2 + 1;
+    int threads = max(1u, thread::hardware_concurrency());
+    for (int i = 4 + n; i + 1 < argc; i++) {
+        if (string(argv[i]) == "--threads") threads = max(1, stoi(argv[i + 1]));
+    }
+    threads = min(threads, rows);
+
+    profiler.enter(PREPROCESS);
+    const knapsack_kernels::Kernels& kernels = knapsack_kernels::active();  // Widest ISA of this host
+    profiler.setKernel(kernels.name);
+
+    // Pin in node order only where there is more than one node to be local to
+    int nodes = 1;
+    vector<int> cpus = cpusByNode(nodes);
+    bool pinned = nodes > 1 && !cpus.empty();
+
+    // Left uninitialized: each worker touches its own slices first
+    size_t planeCells = (size_t)rows * cols;
+    size_t rowWords = ((size_t)cols + 63) / 64;  // Bit rows padded to whole words, so bands never share one
+    unique_ptr<int[]> planeA(new int[planeCells]);
+    unique_ptr<int[]> planeB(new int[planeCells]);
+    unique_ptr<uint64_t[]> took(new uint64_t[(size_t)n * rows * rowWords]);
+    auto bits = [&](int i, int j) { return took.get() + ((size_t)i * rows + j) * rowWords; };
+
+    vector<int> bandStart(threads + 1);
+    for (int t = 0; t <= threads; t++) bandStart[t] = (int)((long long)rows * t / threads);
+
+    profiler.enter(DP);
+    SpinBarrier barrier(threads);
+    vector<OpCounters> perThread(threads);
+    long long barriers = 0;
+
+    auto work = [&](int t) {
+        if (pinned) pinSelf(cpus[t % cpus.size()]);
+        OpCounters& local = perThread[t];
+        int* prev = planeA.get();
+        int* cur = planeB.get();
+        for (int j = bandStart[t]; j < bandStart[t + 1]; j++) memset(prev + (size_t)j * cols, 0, cols * sizeof(int));
+        barrier.wait();  // Row j - w may belong to another band
+
+        for (int i = 0; i < n; i++) {
+            int w = items[i].weight;
+            int m = items[i].volume;
+            int v = items[i].value;
+            if (w > capacity || m > capacity2) {
+                // Nothing changes: keep the planes, record no decisions
+                for (int j = bandStart[t]; j < bandStart[t + 1]; j++) memset(bits(i, j), 0, rowWords * 8);
+                continue;
+            }
+            for (int j = bandStart[t]; j < bandStart[t + 1]; j++) {
+                const int* keep = prev + (size_t)j * cols;
+                int* row = cur + (size_t)j * cols;
+                uint64_t* decided = bits(i, j);
+                if (j < w) {
+                    memcpy(row, keep, cols * sizeof(int));
+                    memset(decided, 0, rowWords * 8);
+                    local.cells += cols;
+                    local.candidates += cols;
+                    continue;
+                }
+                kernels.pairUpdate(keep, prev + (size_t)(j - w) * cols, row, cols, m, v);
+                for (size_t word = 0; word < rowWords; word++) {
+                    size_t end = min<size_t>(64, cols - word * 64);
+                    uint64_t mask = 0;
+                    for (size_t b = 0; b < end; b++) mask |= (uint64_t)(row[word * 64 + b] != keep[word * 64 + b]) << b;
+                    decided[word] = mask;
+                }
+                local.cells += cols;
+                local.candidates += cols + max(0, cols - m);
+            }
+            barrier.wait();  // Plane i is complete before anyone reads it as the previous one
+            swap(prev, cur);
+            if (t == 0) barriers++;
+        }
+    };
+
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) pool.emplace_back(work, t);
+    for (auto& worker : pool) worker.join();
+
+    OpCounters ops;
+    for (const OpCounters& local : perThread) ops += local;
+
+    // Items that fit swapped the planes; the last one written holds the answer
+    long long swaps = 0;
+    for (const Item& item : items) swaps += item.weight <= capacity && item.volume <= capacity2;
+    const int* last = swaps % 2 == 0 ? planeA.get() : planeB.get();
+    int maxValue = last[planeCells - 1];
+
+    profiler.enter(RECONSTRUCT);
+    vector<pair<int, int>> path;  // (row, weight column) of each taken item
+    int j = capacity, k = capacity2;
+    for (int i = n - 1; i >= 0; i--) {
+        if (bits(i, j)[k >> 6] >> (k & 63) & 1) {
+            path.push_back({i + 1, j});
+            j -= items[i].weight;
+            k -= items[i].volume;
+        }
+    }
+
+    profiler.enter(SERIALIZE);
+    JsonBuilder json;
+    json.startObject();
+    json.key("code"); json.value(200);
+    json.key("type"); json.value("2D Cost (Parallel)");
+    json.key("capacity"); json.value(capacity);
+    json.key("capacity2"); json.value(capacity2);
+
+    json.key("items");
+    json.startArray();
+    for (int i = 0; i < n; i++) {
+        json.nextItem();
+        json.startObject();
+        json.key("w"); json.value(items[i].weight);
+        json.key("m"); json.value(items[i].volume);
+        json.key("v"); json.value(items[i].value);
+        json.endObject();
+    }
+    json.endArray();
+
+    // No table to animate
+    json.key("steps");
+    json.startArray();
+    json.endArray();
+
+    json.key("path");
+    json.startArray();
+    for (auto& [r, c] : path) {
+        json.nextItem();
+        json.startObject();
+        json.key("r"); json.value(r);
+        json.key("c"); json.value(c);
+        json.key("item"); json.value(r - 1);
+        json.endObject();
+    }
+    json.endArray();
+
+    json.key("max_value"); json.value(maxValue);
+
+    json.key("parallel");
+    json.startObject();
+    json.key("threads"); json.value(threads);
+    json.key("numa_nodes"); json.value(nodes);
+    json.key("pinned"); json.value(pinned);
+    json.key("barriers"); json.value(barriers);
+    json.endObject();
+
+    auto endTime = chrono::high_resolution_clock::now();
+    double duration = chrono::duration<double, milli>(endTime - startTime).count();
+    json.key("time_ms"); json.value(duration);
+
+    json.key("complexity");
+    json.startObject();
+    json.key("time"); json.value("O(n*C*M/p)");
+    json.key("space"); json.value("O(C*M + n*C*M/64)");
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((long long)(2 * planeCells * sizeof(int) + (size_t)n * rows * rowWords * 8));
+    json.endObject();
+
+    // The root object stays open: the profile is appended after the body has been written
+    writeResult(json.str(), profiler, out);
+    return 0;
+}
+
+}  // namespace knapsack_2d_parallel
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_2d_parallel", knapsack_2d_parallel::run, argc, argv, cout);
+}
+#endif
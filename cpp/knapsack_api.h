@@ -0,0 +1,66 @@
+/**
+ * Solver Library C ABI
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Plain C interface of the solver library (knapsack_lib.cpp), so a host process can run any
+ *              solver in-process instead of spawning its executable. Arguments are exactly the executable's
+ *              command line and the result is exactly its JSON output. Only opaque handles and C types cross
+ *              the boundary; KNAPSACK_ABI_VERSION is bumped whenever a signature or meaning changes
+ */
+
+#ifndef KNAPSACK_API_H
+#define KNAPSACK_API_H
+
+#include <stddef.h>
+
+#if defined(KNAPSACK_STATIC)
+#define KNAPSACK_API
+#elif defined(_WIN32)
+#ifdef KNAPSACK_BUILD_DLL
+#define KNAPSACK_API __declspec(dllexport)
+#else
+#define KNAPSACK_API __declspec(dllimport)
+#endif
+#else
+#define KNAPSACK_API __attribute__((visibility("default")))
+#endif
+
+#define KNAPSACK_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct knapsack_result knapsack_result;
+typedef struct knapsack_cancel_token knapsack_cancel_token;
+
+enum knapsack_status {
+    KNAPSACK_OK = 0,
+    KNAPSACK_INVALID = 1,            /* The solver rejected its input; the result holds its error JSON */
+    KNAPSACK_UNKNOWN_ALGORITHM = 2,
+    KNAPSACK_CANCELLED = 3,
+    KNAPSACK_FAILED = 4              /* Out of memory or another internal error */
+};
+
+KNAPSACK_API int knapsack_abi_version(void);
+
+/* Cancellation: knapsack_cancel may be called from any thread while a solve using the token runs */
+KNAPSACK_API knapsack_cancel_token* knapsack_cancel_token_create(void);
+KNAPSACK_API void knapsack_cancel(knapsack_cancel_token* token);
+KNAPSACK_API void knapsack_cancel_token_free(knapsack_cancel_token* token);
+
+/* Runs one solver on the calling thread. argv[0] is the algorithm name, as for the executable; cancel may
+ * be NULL. On KNAPSACK_OK and KNAPSACK_INVALID *result receives the output, owned by the caller */
+KNAPSACK_API int knapsack_solve(const char* algorithm, int argc, const char* const* argv,
+                                knapsack_cancel_token* cancel, knapsack_result** result);
+
+/* UTF-8 JSON, not NUL-terminated; valid until the result is freed */
+KNAPSACK_API const char* knapsack_result_data(const knapsack_result* result, size_t* length);
+KNAPSACK_API void knapsack_result_free(knapsack_result* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KNAPSACK_API_H */
@@ -0,0 +1,176 @@
+/**
+ * Batch Solver
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Solves a stream of instances for any algorithm in one process on a work-stealing thread pool.
+ *              Reads one instance per line from stdin and writes one JSON line per instance, tagged with
+ *              its id, in completion order, followed by a summary line with latency percentiles
+ *
+ * Usage:
+ *   knapsack_batch.exe [--threads N] < instances.txt
+ *
+ * Input line:  <id> <algorithm> <solver arguments...>   e.g.  7 knapsack_01 10 3 2,3 4,5 1,1
+ * Output line: {"id":"7","algorithm":"knapsack_01","worker":0,"queue_ms":..,"solve_ms":..,"result":{...}}
+ */
+
+// Every solver below is compiled as a library: its main() is left out and run() is called directly
+#define KNAPSACK_LIBRARY
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <cmath>
+#include <climits>
+#include <cstdint>
+#include <thread>
+#include <functional>
+#include "knapsack_profile.h"
+#include "knapsack_cache.h"
+#include "thread_pool.h"
+
+#include "knapsack_registry.h"
+
+using namespace std;
+
+namespace knapsack_batch {
+
+using knapsack_registry::SOLVERS;
+
+using Clock = chrono::steady_clock;
+
+struct Instance {
+    string id;
+    string algorithm;
+    vector<string> args;  // args[0] is the algorithm name, as argv[0] would be
+    Clock::time_point submitted;
+};
+
+// Ids and messages end up inside JSON strings
+string escape(const string& s) {
+    string r;
+    for (char c : s) {
+        if (c == '"' || c == '\\') r += '\\';
+        if ((unsigned char)c >= 0x20) r += c;
+    }
+    return r;
+}
+
+double ms(Clock::duration d) { return chrono::duration<double, milli>(d).count(); }
+
+// Nearest-rank percentile of an ascending list
+double percentile(const vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = (size_t)ceil(p / 100.0 * sorted.size());
+    return sorted[min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+string percentiles(vector<double> values) {
+    sort(values.begin(), values.end());
+    stringstream ss;
+    ss << "{\"p50\":" << percentile(values, 50) << ",\"p90\":" << percentile(values, 90)
+       << ",\"p99\":" << percentile(values, 99) << ",\"max\":" << (values.empty() ? 0 : values.back()) << "}";
+    return ss.str();
+}
+
+class BatchRunner {
+private:
+    WorkStealingPool pool;
+    mutex outMutex;
+    vector<double> latencies;   // Submit to completion
+    vector<double> solveTimes;  // Time inside the solver
+    long long failed = 0;
+
+    void solve(const Instance& inst, int worker) {
+        Clock::time_point start = Clock::now();
+        stringstream result;
+        int code = 1;
+        auto it = SOLVERS.find(inst.algorithm);
+        if (it == SOLVERS.end()) {
+            result << R"({"code":400,"error":"Unknown algorithm"})";
+        } else {
+            vector<char*> argv;
+            for (const string& a : inst.args) argv.push_back(const_cast<char*>(a.c_str()));
+            argv.push_back(nullptr);
+            try {
+                code = knapsack_cache::cachedRun(inst.algorithm.c_str(), it->second, (int)inst.args.size(),
+                                                 argv.data(), result);
+            } catch (const exception& e) {
+                result.str("");
+                result << "{\"code\":400,\"error\":\"Invalid instance: " << escape(e.what()) << "\"}";
+                code = 1;
+            }
+        }
+        Clock::time_point end = Clock::now();
+
+        stringstream line;
+        line << "{\"id\":\"" << escape(inst.id) << "\",\"algorithm\":\"" << escape(inst.algorithm) << "\""
+             << ",\"worker\":" << worker << ",\"queue_ms\":" << ms(start - inst.submitted)
+             << ",\"solve_ms\":" << ms(end - start) << ",\"result\":" << result.str() << "}\n";
+
+        lock_guard<mutex> lock(outMutex);
+        cout << line.str();
+        cout.flush();
+        latencies.push_back(ms(end - inst.submitted));
+        solveTimes.push_back(ms(end - start));
+        if (code != 0) failed++;
+    }
+
+public:
+    explicit BatchRunner(unsigned threads) : pool(threads) {}
+
+    void submit(Instance inst) {
+        inst.submitted = Clock::now();
+        pool.submit([this, inst = move(inst)]() {
+            solve(inst, pool.workerIndex());
+        });
+    }
+
+    void finish(Clock::time_point started) {
+        pool.wait();
+        double wall = ms(Clock::now() - started);
+        long long count = latencies.size();
+        cout << "{\"summary\":{\"instances\":" << count << ",\"failed\":" << failed
+             << ",\"threads\":" << pool.size() << ",\"steals\":" << pool.stealCount()
+             << ",\"wall_ms\":" << wall << ",\"throughput_per_s\":" << (wall > 0 ? count * 1000.0 / wall : 0)
+             << ",\"latency_ms\":" << percentiles(latencies) << ",\"solve_ms\":" << percentiles(solveTimes)
+             << "}}\n";
+        cout.flush();
+    }
+};
+
+}  // namespace knapsack_batch
+
+int main(int argc, char* argv[]) {
+    using namespace knapsack_batch;
+    Clock::time_point started = Clock::now();
+
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--threads" && i + 1 < argc) threads = max(1, stoi(argv[++i]));
+    }
+
+    BatchRunner runner(threads);
+
+    // Instances are dispatched while the rest of the input is still being read
+    string text;
+    while (getline(cin, text)) {
+        stringstream ss(text);
+        Instance inst;
+        if (!(ss >> inst.id) || inst.id[0] == '#') continue;
+        ss >> inst.algorithm;
+        if (inst.algorithm.rfind("knapsack_", 0) != 0) inst.algorithm = "knapsack_" + inst.algorithm;
+        inst.args.push_back(inst.algorithm);
+        string arg;
+        while (ss >> arg) inst.args.push_back(arg);
+        runner.submit(move(inst));
+    }
+
+    runner.finish(started);
+    return 0;
+}
@@ -0,0 +1,208 @@
+/**
+ * On-Disk Result Cache
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Content-addressed store of solver results. The key is an FNV-1a hash of the solver name, its
+ *              canonicalized arguments (capacity, parameters, item list) and the environment settings that
+ *              change a result body (OUTPUT_ENV); a hit maps the stored file
+ *              and writes it out without solving. Enabled by KNAPSACK_CACHE_DIR, bounded by
+ *              KNAPSACK_CACHE_BYTES (default 256 MB) with least-recently-used files evicted first
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "knapsack_profile.h"
+#include "mapped_file.h"
+
+namespace knapsack_cache {
+
+namespace fs = std::filesystem;
+
+using SolverFn = int (*)(int, char*[], std::ostream&);
+
+// Results from an older build must not be served: the build stamp is part of every key
+constexpr const char* BUILD_STAMP = __DATE__ " " __TIME__;
+
+// Settings read by the solvers that change a stored body: the forced cell type shows in cell_type and the
+// value width. KNAPSACK_ISA only shows in the profile and row store results are never stored
+constexpr const char* OUTPUT_ENV[] = {"KNAPSACK_CELL"};
+
+constexpr unsigned long long DEFAULT_BUDGET_BYTES = 256ULL * 1024 * 1024;
+
+inline void fnv1a(uint64_t& h, const char* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)data[i];
+        h *= 1099511628211ULL;
+    }
+}
+
+// Integer fields are re-printed so "05,3" and "5,3" hash the same; anything else is hashed verbatim
+inline std::string canonicalArg(const char* arg) {
+    std::string out;
+    std::stringstream fields(arg);
+    std::string field;
+    bool first = true;
+    while (std::getline(fields, field, ',')) {
+        if (!first) out += ',';
+        first = false;
+        char* end = nullptr;
+        long long v = std::strtoll(field.c_str(), &end, 10);
+        out += (!field.empty() && *end == '\0') ? std::to_string(v) : field;
+    }
+    return out;
+}
+
+inline std::string cacheKey(const char* solver, int argc, char* argv[]) {
+    uint64_t h = 14695981039346656037ULL;
+    fnv1a(h, BUILD_STAMP, std::char_traits<char>::length(BUILD_STAMP) + 1);
+    fnv1a(h, solver, std::char_traits<char>::length(solver) + 1);
+    for (const char* name : OUTPUT_ENV) {
+        const char* value = std::getenv(name);
+        std::string setting = std::string(name) + "=" + (value ? value : "");
+        fnv1a(h, setting.c_str(), setting.size() + 1);
+    }
+    for (int i = 1; i < argc; i++) {
+        std::string arg = canonicalArg(argv[i]);
+        fnv1a(h, arg.c_str(), arg.size() + 1);
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)h);
+    return hex;
+}
+
+class DiskCache {
+private:
+    fs::path dir;
+    unsigned long long budget = DEFAULT_BUDGET_BYTES;
+
+public:
+    DiskCache() {
+        const char* d = std::getenv("KNAPSACK_CACHE_DIR");
+        if (!d || !*d) return;
+        std::error_code ec;
+        fs::create_directories(d, ec);
+        if (ec) return;
+        dir = d;
+        if (const char* b = std::getenv("KNAPSACK_CACHE_BYTES")) budget = std::strtoull(b, nullptr, 10);
+    }
+
+    bool enabled() const { return !dir.empty() && budget > 0; }
+
+    fs::path pathFor(const std::string& key) const { return dir / (key + ".json"); }
+
+    // Map a stored result; the file's timestamp is bumped so eviction sees it as recently used
+    MappedFile lookup(const std::string& key) const {
+        fs::path p = pathFor(key);
+        MappedFile file(p.string());
+        if (file.valid()) {
+            std::error_code ec;
+            fs::last_write_time(p, fs::file_time_type::clock::now(), ec);
+        }
+        return file;
+    }
+
+    // Write to a temporary name and rename, so concurrent readers only ever map complete files
+    void store(const std::string& key, const std::string& body) {
+        if (body.size() > budget) return;
+        fs::path p = pathFor(key);
+        fs::path tmp = p;
+        tmp += ".tmp" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+        {
+            std::ofstream f(tmp, std::ios::binary);
+            f.write(body.data(), (std::streamsize)body.size());
+            if (!f) {
+                std::error_code ec;
+                fs::remove(tmp, ec);
+                return;
+            }
+        }
+        std::error_code ec;
+        fs::rename(tmp, p, ec);
+        if (ec) fs::remove(tmp, ec);
+        evict();
+    }
+
+    // Drop the least recently used results until the directory fits the budget
+    void evict() {
+        struct Entry {
+            fs::path path;
+            fs::file_time_type used;
+            unsigned long long bytes;
+        };
+        std::vector<Entry> entries;
+        unsigned long long total = 0;
+        std::error_code ec;
+        for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->path().extension() != ".json") continue;
+            std::error_code fec;
+            unsigned long long bytes = it->file_size(fec);
+            fs::file_time_type used = it->last_write_time(fec);
+            if (fec) continue;
+            entries.push_back({it->path(), used, bytes});
+            total += bytes;
+        }
+        if (total <= budget) return;
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.used < b.used; });
+        for (const Entry& e : entries) {
+            if (total <= budget) break;
+            std::error_code rec;
+            if (fs::remove(e.path, rec)) total -= e.bytes;
+        }
+    }
+};
+
+inline std::string cacheJson(bool hit, const std::string& key, size_t bytes) {
+    std::stringstream ss;
+    ss << ",\"cache\":{\"hit\":" << (hit ? "true" : "false") << ",\"tier\":\"disk\",\"key\":\"" << key
+       << "\",\"bytes\":" << bytes << "}";
+    return ss.str();
+}
+
+// Serve a run from the disk cache, or run the solver and store its result body (everything but "profile").
+// Without KNAPSACK_CACHE_DIR this is a plain call to the solver
+inline int cachedRun(const char* solver, SolverFn run, int argc, char* argv[], std::ostream& out) {
+    DiskCache cache;
+    if (!cache.enabled()) return run(argc, argv, out);
+
+    knapsack_profile::Profiler profiler;
+    std::string key = cacheKey(solver, argc, argv);
+    MappedFile hit = cache.lookup(key);
+    if (hit.valid()) {
+        // Written straight from the mapping, no copy of a possibly large trace
+        profiler.enter(knapsack_profile::WRITE);
+        out.write(hit.data(), (std::streamsize)hit.size());
+        out << cacheJson(true, key, hit.size()) << ",\"profile\":" << profiler.json() << "}";
+        out.flush();
+        return 0;
+    }
+
+    std::stringstream captured;
+    int code = run(argc, argv, captured);
+    std::string output = captured.str();
+    size_t tail = output.rfind(",\"profile\":");
+    if (code != 0 || tail == std::string::npos) {
+        out << output;
+        return code;
+    }
+    std::string body = output.substr(0, tail);
+    out << body << cacheJson(false, key, body.size()) << output.substr(tail);
+    out.flush();
+    // A mapped DP table (row_store.h) belongs to this run only; its file is deleted once read
+    if (body.find("\"row_store\":") == std::string::npos) cache.store(key, body);
+    return code;
+}
+
+}  // namespace knapsack_cache
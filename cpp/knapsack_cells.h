@@ -0,0 +1,85 @@
+/**
+ * DP Cell Types
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Narrowest integer type that holds every value a DP can reach, picked at run time from an
+ *              upper bound on the total value. Solvers instantiate their DP once per type and dispatch on
+ *              the bound, so small values run in 16-bit vector lanes (twice the cells per vector of int and
+ *              half the memory traffic) and totals past 2^31 no longer overflow:
+ *                uint16   bound < 2^16 and no negative values
+ *                int32    bound < 2^31
+ *                int64    bound < 2^63
+ *                int128   anything larger
+ *              The bound has to cover every candidate the recurrence forms (row[j - w] + v), not only the
+ *              optimum. KNAPSACK_CELL=<type> raises the choice to at least that type, e.g. to compare types
+ *              on one instance; it never narrows below what the bound needs. Solvers whose DP is still int
+ *              or int64 only compute the same bound and reject instances past their type with a 400
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+
+namespace knapsack_cells {
+
+typedef __int128 int128;
+
+enum Cell { UINT16, INT32, INT64, INT128 };
+
+template <class T> const char* name();
+template <> inline const char* name<uint16_t>() { return "uint16"; }
+template <> inline const char* name<int32_t>() { return "int32"; }
+template <> inline const char* name<int64_t>() { return "int64"; }
+template <> inline const char* name<int128>() { return "int128"; }
+
+// Decimal text of a cell: uint16 would print as a character code, int128 has no stream operator
+inline void write(std::ostream& os, uint16_t v) { os << (unsigned)v; }
+inline void write(std::ostream& os, int32_t v) { os << v; }
+inline void write(std::ostream& os, int64_t v) { os << v; }
+inline void write(std::ostream& os, int128 v) {
+    unsigned __int128 u = v < 0 ? -(unsigned __int128)v : (unsigned __int128)v;
+    char digits[40];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + (int)(u % 10));
+        u /= 10;
+    } while (u > 0);
+    if (v < 0) os << '-';
+    while (count > 0) os << digits[--count];
+}
+
+// |v| without overflow, for summing bounds
+inline int128 magnitude(long long v) { return v < 0 ? -(int128)v : (int128)v; }
+
+// bound: largest magnitude any candidate can reach; negative: some candidate can drop below zero
+inline Cell select(int128 bound, bool negative) {
+    Cell cell = INT128;
+    if (!negative && bound <= UINT16_MAX) cell = UINT16;
+    else if (bound <= INT32_MAX) cell = INT32;
+    else if (bound <= INT64_MAX) cell = INT64;
+
+    if (const char* floor = std::getenv("KNAPSACK_CELL")) {
+        const char* names[] = {"uint16", "int32", "int64", "int128"};
+        for (int c = 0; c < 4; c++) {
+            if (std::strcmp(floor, names[c]) == 0 && c > cell) cell = (Cell)c;
+        }
+    }
+    return cell;
+}
+
+// Call f with a zero of the selected type; f instantiates its DP for decltype of that argument
+template <class F>
+auto dispatch(int128 bound, bool negative, F&& f) {
+    switch (select(bound, negative)) {
+        case UINT16: return f(uint16_t());
+        case INT32: return f(int32_t());
+        case INT64: return f(int64_t());
+        default: return f(int128());
+    }
+}
+
+}  // namespace knapsack_cells
@@ -3,7 +3,9 @@
  * 
  * @author Cyans
  * @affiliation Chang'an University
- * @description Dynamic programming solution for complete knapsack problem where each item can be selected unlimited times
+ * @description Dynamic programming solution for complete knapsack problem where each item can be selected unlimited times.
+ *              Each row runs through the stride-w kernel (knapsack_kernels.h) in the narrowest cell type that
+ *              holds the best total value (knapsack_cells.h)
  */
 
 #include <iostream>
@@ -12,12 +14,20 @@
 #include <sstream>
 #include <algorithm>
 #include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_keyframes.h"
+#include "knapsack_kernels.h"
+#include "knapsack_cells.h"
 
 using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_complete {
 
 struct Item {
     int weight;
-    int value;
+    long long value;
 };
 
 class JsonBuilder {
@@ -26,17 +36,21 @@ private:
     bool firstItem = true;
 public:
     void startObject() { ss << "{"; firstItem = true; }
-    void endObject() { ss << "}"; }
+    void endObject() { ss << "}"; firstItem = false; }
     void startArray() { ss << "["; firstItem = true; }
-    void endArray() { ss << "]"; }
+    void endArray() { ss << "]"; firstItem = false; }
     void key(const string& k) {
         if (!firstItem) ss << ",";
         ss << "\"" << k << "\":";
         firstItem = false;
     }
     void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
     void value(const string& v) { ss << "\"" << v << "\""; }
     void value(double v) { ss << v; }
+    void raw(const string& v) { ss << v; }
+    template <class T>
+    void cell(T v) { knapsack_cells::write(ss, v); }
     void nextItem() {
         if (!firstItem) ss << ",";
         firstItem = false;
@@ -44,28 +58,16 @@ public:
     string str() { return ss.str(); }
 };
 
-int main(int argc, char* argv[]) {
-    auto startTime = chrono::high_resolution_clock::now();
-    
-    if (argc < 3) {
-        cout << R"({"code":400,"error":"Insufficient parameters"})";
-        return 1;
-    }
-    
-    int capacity = stoi(argv[1]);
-    int n = stoi(argv[2]);
-    
-    vector<Item> items(n);
-    for (int i = 0; i < n && i + 3 < argc; i++) {
-        string arg = argv[i + 3];
-        size_t comma = arg.find(',');
-        items[i].weight = stoi(arg.substr(0, comma));
-        items[i].value = stoi(arg.substr(comma + 1));
-    }
+// The DP for one cell type T, which holds every value the table can reach
+template <class T>
+int solve(int capacity, const vector<Item>& items, Profiler& profiler,
+          chrono::high_resolution_clock::time_point startTime, ostream& out) {
+    int n = items.size();
     
     // Use 2D array for easy visualization
-    vector<vector<int>> dp(n + 1, vector<int>(capacity + 1, 0));
+    vector<vector<T>> dp(n + 1, vector<T>(capacity + 1, T()));
     
+    profiler.enter(SERIALIZE);
     JsonBuilder json;
     json.startObject();
     json.key("code"); json.value(200);
@@ -83,85 +85,94 @@ int main(int argc, char* argv[]) {
     }
     json.endArray();
     
+    OpCounters ops;  // Work done by the DP kernel
+    const knapsack_kernels::RowKernels<T>& kernels = knapsack_kernels::rowKernels<T>();  // Widest ISA of this host
+    profiler.setKernel(kernels.name);
+    
+    knapsack_trace::KeyframeRecorder<T> keyframes(n + 1, capacity + 1);
+    
     json.key("steps");
     json.startArray();
     
-    // Complete knapsack: forward iteration in inner loop
+    // Complete knapsack: forward iteration in inner loop; compute each row, then emit its steps
     for (int i = 1; i <= n; i++) {
         int w = items[i - 1].weight;
-        int v = items[i - 1].value;
+        T v = (T)items[i - 1].value;
+        
+        // Complete knapsack: can transfer from left of this row (same item can be selected multiple times),
+        // dp[i][j] = max(dp[i-1][j], dp[i][j-w] + v)
+        profiler.enter(DP);
+        dp[i] = dp[i - 1];
+        kernels.unboundedRow(dp[i].data(), capacity + 1, w, v);
+        
+        ops.cells += capacity + 1;
+        ops.candidates += capacity + 1 + max(0, capacity - w + 1);  // Skip everywhere, take where it fits
         
+        profiler.enter(SERIALIZE);
         for (int j = 0; j <= capacity; j++) {
             json.nextItem();
             json.startObject();
             json.key("row"); json.value(i);
             json.key("col"); json.value(j);
-            
-            if (j < w) {
-                dp[i][j] = dp[i - 1][j];
-                json.key("val"); json.value(dp[i][j]);
-                json.key("highlight");
-                json.startArray();
-                json.nextItem();
-                json.startObject();
-                json.key("r"); json.value(i - 1);
-                json.key("c"); json.value(j);
-                json.key("type"); json.value("without");
-                json.endObject();
-                json.endArray();
-                json.key("decision"); json.value("skip");
-            } else {
-                // Complete knapsack: can transfer from left of this row (same item can be selected multiple times)
-                int withoutItem = dp[i - 1][j];
-                int withItem = dp[i][j - w] + v;  // Note: this is dp[i] not dp[i-1]
-                dp[i][j] = max(withoutItem, withItem);
-                
-                json.key("val"); json.value(dp[i][j]);
-                json.key("highlight");
-                json.startArray();
-                json.nextItem();
-                json.startObject();
-                json.key("r"); json.value(i - 1);
-                json.key("c"); json.value(j);
-                json.key("type"); json.value("without");
-                json.endObject();
+            json.key("val"); json.cell(dp[i][j]);
+            keyframes.step(i, j, dp[i][j]);
+            json.key("highlight");
+            json.startArray();
+            json.nextItem();
+            json.startObject();
+            json.key("r"); json.value(i - 1);
+            json.key("c"); json.value(j);
+            json.key("type"); json.value("without");
+            json.endObject();
+            if (j >= w) {
                 json.nextItem();
                 json.startObject();
                 json.key("r"); json.value(i);  // This row
                 json.key("c"); json.value(j - w);
                 json.key("type"); json.value("with");
                 json.endObject();
-                json.endArray();
-                
-                json.key("decision"); 
-                json.value(dp[i][j] == withoutItem ? "skip" : "take");
             }
+            json.endArray();
+            
+            json.key("decision"); 
+            json.value(j < w || dp[i][j] == dp[i - 1][j] ? "skip" : "take");
             json.endObject();
         }
     }
     json.endArray();
+    json.key("keyframes"); json.raw(keyframes.json());
+    
+    profiler.setDpCells(ops.cells);
     
     // Backtrack path
-    json.key("path");
-    json.startArray();
+    profiler.enter(RECONSTRUCT);
+    vector<pair<int, int>> path;  // (row, col) of each taken copy
     int j = capacity;
     for (int i = n; i > 0 && j > 0; ) {
         if (dp[i][j] != dp[i - 1][j]) {
-            json.nextItem();
-            json.startObject();
-            json.key("r"); json.value(i);
-            json.key("c"); json.value(j);
-            json.key("item"); json.value(i - 1);
-            json.endObject();
+            path.push_back({i, j});
             j -= items[i - 1].weight;
             // Complete knapsack: do not decrease i, can select same item again
         } else {
             i--;
         }
     }
+    
+    profiler.enter(SERIALIZE);
+    json.key("path");
+    json.startArray();
+    for (auto& [r, c] : path) {
+        json.nextItem();
+        json.startObject();
+        json.key("r"); json.value(r);
+        json.key("c"); json.value(c);
+        json.key("item"); json.value(r - 1);
+        json.endObject();
+    }
     json.endArray();
     
-    json.key("max_value"); json.value(dp[n][capacity]);
+    json.key("max_value"); json.cell(dp[n][capacity]);
+    json.key("cell_type"); json.value(knapsack_cells::name<T>());
     
     auto endTime = chrono::high_resolution_clock::now();
     double duration = chrono::duration<double, milli>(endTime - startTime).count();
@@ -171,15 +182,66 @@ int main(int argc, char* argv[]) {
     json.startObject();
     json.key("time"); json.value("O(n*C)");
     json.key("space"); json.value("O(n*C)");
-    json.key("operations"); json.value(n * (capacity + 1));
-    json.key("memory_bytes"); json.value((n + 1) * (capacity + 1) * 4);
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((long long)(n + 1) * (capacity + 1) * (long long)sizeof(T));
     json.endObject();
     
-    json.endObject();
-    cout << json.str();
+    // The root object stays open: the profile is appended after the body has been written
+    writeResult(json.str(), profiler, out);
     return 0;
 }
 
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
+    auto startTime = chrono::high_resolution_clock::now();
+    
+    if (argc < 3) {
+        out << R"({"code":400,"error":"Insufficient parameters"})";
+        return 1;
+    }
+    
+    int capacity = stoi(argv[1]);
+    int n = stoi(argv[2]);
+    
+    vector<Item> items(n);
+    for (int i = 0; i < n && i + 3 < argc; i++) {
+        string arg = argv[i + 3];
+        size_t comma = arg.find(',');
+        items[i].weight = stoi(arg.substr(0, comma));
+        items[i].value = stoll(arg.substr(comma + 1));
+        if (items[i].weight <= 0) {
+            out << R"({"code":400,"error":"Items need a positive weight"})";
+            return 1;
+        }
+    }
+    
+    // A cell holds at most the whole capacity filled at the best value/weight ratio, and every candidate
+    // dp[i][j-w] + v stays within that or |v|
+    profiler.enter(PREPROCESS);
+    knapsack_cells::int128 bound = 0;
+    bool negative = false;
+    for (const Item& item : items) {
+        knapsack_cells::int128 v = item.value < 0 ? -(knapsack_cells::int128)item.value : item.value;
+        negative = negative || item.value < 0;
+        bound = max(bound, max(v, v * capacity / item.weight));
+    }
+    return knapsack_cells::dispatch(bound, negative, [&](auto zero) {
+        return solve<decltype(zero)>(capacity, items, profiler, startTime, out);
+    });
+}
+
+}  // namespace knapsack_complete
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_complete", knapsack_complete::run, argc, argv, cout);
+}
+#endif
+
 
 
 
@@ -10,9 +10,17 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <climits>
 #include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_keyframes.h"
+#include "knapsack_trace_codec.h"
 
 using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_count {
 
 struct Item {
     int weight;
@@ -34,8 +42,10 @@ public:
         firstItem = false;
     }
     void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
     void value(const string& v) { ss << "\"" << v << "\""; }
     void value(double v) { ss << v; }
+    void raw(const string& v) { ss << v; }
     void nextItem() {
         if (!firstItem) ss << ",";
         firstItem = false;
@@ -43,11 +53,12 @@ public:
     string str() { return ss.str(); }
 };
 
-int main(int argc, char* argv[]) {
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
     auto startTime = chrono::high_resolution_clock::now();
     
     if (argc < 3) {
-        cout << R"({"code":400,"error":"Insufficient parameters"})";
+        out << R"({"code":400,"error":"Insufficient parameters"})";
         return 1;
     }
     
@@ -63,9 +74,11 @@ int main(int argc, char* argv[]) {
     }
     
     // DP[i][j] = number of ways to exactly fill capacity j with first i items
+    profiler.enter(PREPROCESS);
     vector<vector<int>> dp(n + 1, vector<int>(capacity + 1, 0));
     dp[0][0] = 1;  // Initialize: 1 way when capacity is 0 (select nothing)
     
+    profiler.enter(SERIALIZE);
     JsonBuilder json;
     json.startObject();
     json.key("code"); json.value(200);
@@ -83,12 +96,43 @@ int main(int argc, char* argv[]) {
     }
     json.endArray();
     
-    json.key("steps");
-    json.startArray();
+    OpCounters ops;  // Work done by the DP kernel
+    
+    // With --trace=packed the rows are delta-encoded instead of written as steps (knapsack_trace_codec.h)
+    const bool packed = knapsack_trace::packedRequested(argc, argv);
+    knapsack_trace::DeltaEncoder trace(capacity + 1, "row");
+    if (packed) trace.row<int>(nullptr, dp[0].data());  // Row 0 first: the base of row 1
+    knapsack_trace::KeyframeRecorder keyframes(packed ? 0 : n + 1, capacity + 1);
+    
+    if (!packed) {
+        json.key("steps");
+        json.startArray();
+    }
     
     for (int i = 1; i <= n; i++) {
         int w = items[i - 1].weight;
         
+        // Counts reach up to 2^i, so they are checked as they are formed instead of bounded up front
+        profiler.enter(DP);
+        bool overflow = false;
+        for (int j = 0; j <= capacity; j++) {
+            long long ways = (long long)dp[i - 1][j] + ((j >= w) ? dp[i - 1][j - w] : 0);
+            overflow = overflow || ways > INT_MAX;
+            dp[i][j] = (int)ways;
+        }
+        if (overflow) {
+            out << R"({"code":400,"error":"Number of ways exceeds the int range of the DP"})";
+            return 1;
+        }
+        
+        ops.cells += capacity + 1;
+        ops.candidates += capacity + 1 + max(0, capacity - w + 1);  // Skip everywhere, take where it fits
+        
+        profiler.enter(SERIALIZE);
+        if (packed) {
+            trace.row(dp[i - 1].data(), dp[i].data());
+            continue;
+        }
         for (int j = 0; j <= capacity; j++) {
             json.nextItem();
             json.startObject();
@@ -97,9 +141,9 @@ int main(int argc, char* argv[]) {
             
             int notTake = dp[i - 1][j];
             int take = (j >= w) ? dp[i - 1][j - w] : 0;
-            dp[i][j] = notTake + take;
             
             json.key("val"); json.value(dp[i][j]);
+            keyframes.step(i, j, dp[i][j]);
             json.key("notTake"); json.value(notTake);
             json.key("take"); json.value(take);
             
@@ -126,7 +170,12 @@ int main(int argc, char* argv[]) {
             json.endObject();
         }
     }
-    json.endArray();
+    if (packed) {
+        json.key("trace"); json.raw(trace.json());
+    } else {
+        json.endArray();
+        json.key("keyframes"); json.raw(keyframes.json());
+    }
     
     // Solution counting has no traditional "path", but can list solution counts for all capacities
     json.key("path");
@@ -143,15 +192,27 @@ int main(int argc, char* argv[]) {
     json.startObject();
     json.key("time"); json.value("O(n*C)");
     json.key("space"); json.value("O(n*C)");
-    json.key("operations"); json.value(n * (capacity + 1));
-    json.key("memory_bytes"); json.value((n + 1) * (capacity + 1) * 8);
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((long long)(n + 1) * (capacity + 1) * 8);
     json.endObject();
     
-    json.endObject();
-    cout << json.str();
+    // The root object stays open: the profile is appended after the body has been written
+    writeResult(json.str(), profiler, out);
     return 0;
 }
 
+}  // namespace knapsack_count
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_count", knapsack_count::run, argc, argv, cout);
+}
+#endif
+
 
 
 
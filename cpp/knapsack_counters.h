@@ -0,0 +1,182 @@
+/**
+ * Hardware Performance Counters
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Optional perf_event_open counters (cycles, instructions, L1D/LLC misses, branch misses)
+ *              that the profiler switches on only while a solver is in its dp phase.
+ *              Enabled with KNAPSACK_COUNTERS=1; on other platforms or without permission the result
+ *              reports "available": false with the reason instead of numbers
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace knapsack_profile {
+
+class HardwareCounters {
+private:
+    struct Event {
+        const char* name;
+        uint32_t type;
+        uint64_t config;
+    };
+
+    std::vector<const char*> names;  // Events that opened, in group read order
+    std::vector<int> fds;
+    std::vector<uint64_t> totals;
+    uint64_t timeEnabled = 0;
+    uint64_t timeRunning = 0;
+    bool requested = false;
+    bool running = false;
+    std::string reason;
+
+#ifdef __linux__
+    static int openEvent(const Event& e, int groupFd) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = e.type;
+        attr.config = e.config;
+        attr.disabled = groupFd < 0 ? 1 : 0;  // Members follow the leader
+        attr.exclude_kernel = 1;              // Allowed at perf_event_paranoid <= 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return (int)syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+    }
+
+    // Read the group totals; values are scaled up when the kernel multiplexed the group
+    void collect() {
+        std::vector<uint64_t> buf(3 + fds.size());
+        if (::read(fds[0], buf.data(), buf.size() * sizeof(uint64_t)) <= 0) return;
+        timeEnabled = buf[1];
+        timeRunning = buf[2];
+        for (size_t i = 0; i < fds.size() && i < buf[0]; i++) {
+            uint64_t v = buf[3 + i];
+            bool scaled = timeRunning > 0 && timeRunning < timeEnabled;
+            totals[i] = scaled ? (uint64_t)((double)v * timeEnabled / timeRunning) : v;
+        }
+    }
+#endif
+
+    long long total(const char* name) const {
+        for (size_t i = 0; i < names.size(); i++) {
+            if (std::strcmp(names[i], name) == 0) return (long long)totals[i];
+        }
+        return -1;
+    }
+
+public:
+    HardwareCounters() {
+        const char* env = std::getenv("KNAPSACK_COUNTERS");
+        if (!env || std::strcmp(env, "0") == 0) return;
+        requested = true;
+#ifdef __linux__
+        const uint64_t l1dReadMiss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const Event events[] = {
+            {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {"l1d_read_misses", PERF_TYPE_HW_CACHE, l1dReadMiss},
+            {"llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        };
+        // The first event that opens leads the group; events this CPU or VM lacks are skipped
+        for (const Event& e : events) {
+            int fd = openEvent(e, fds.empty() ? -1 : fds[0]);
+            if (fd < 0) {
+                if (fds.empty() && reason.empty()) reason = std::string("perf_event_open: ") + std::strerror(errno);
+                continue;
+            }
+            fds.push_back(fd);
+            names.push_back(e.name);
+        }
+        totals.assign(fds.size(), 0);
+        if (!fds.empty()) reason.clear();
+#else
+        reason = "perf_event_open is Linux only";
+#endif
+    }
+
+    ~HardwareCounters() {
+#ifdef __linux__
+        for (int fd : fds) close(fd);
+#endif
+    }
+
+    HardwareCounters(const HardwareCounters&) = delete;
+    HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+    bool enabled() const { return requested; }
+    bool available() const { return !fds.empty(); }
+
+    void resume() {
+#ifdef __linux__
+        if (!available() || running) return;
+        ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        running = true;
+#endif
+    }
+
+    void pause() {
+#ifdef __linux__
+        if (!running) return;
+        ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        running = false;
+#endif
+    }
+
+    // Counter object for the profile, summed over every dp window; cells is the solver's dp work (0 = unknown)
+    std::string json(long long cells) {
+        std::stringstream ss;
+        if (!available()) {
+            ss << "{\"available\":false,\"reason\":\"" << reason << "\"}";
+            return ss.str();
+        }
+#ifdef __linux__
+        pause();
+        collect();
+#endif
+        ss << "{\"available\":true,\"scope\":\"dp\",\"events\":{";
+        for (size_t i = 0; i < names.size(); i++) {
+            if (i > 0) ss << ",";
+            ss << "\"" << names[i] << "\":" << totals[i];
+        }
+        ss << "}";
+        ss << ",\"multiplexed\":" << (timeRunning < timeEnabled ? "true" : "false");
+
+        // Derived metrics, only for the events that were counted
+        long long cycles = total("cycles");
+        long long instructions = total("instructions");
+        long long llc = total("llc_misses");
+        long long branches = total("branch_misses");
+        if (cycles > 0 && instructions >= 0) ss << ",\"ipc\":" << (double)instructions / cycles;
+        if (cells > 0) {
+            ss << ",\"cells\":" << cells;
+            if (cycles > 0) ss << ",\"cells_per_cycle\":" << (double)cells / cycles;
+            if (llc >= 0) ss << ",\"llc_misses_per_kcell\":" << 1000.0 * llc / cells;
+        }
+        if (instructions > 0) {
+            if (llc >= 0) ss << ",\"llc_mpki\":" << 1000.0 * llc / instructions;
+            if (branches >= 0) ss << ",\"branch_mpki\":" << 1000.0 * branches / instructions;
+        }
+        ss << "}";
+        return ss.str();
+    }
+};
+
+}  // namespace knapsack_profile
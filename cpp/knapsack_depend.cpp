@@ -11,10 +11,18 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <climits>
 #include <map>
 #include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_cells.h"
+#include "knapsack_kernels.h"
 
 using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_depend {
 
 struct Item {
     int weight;
@@ -35,15 +43,16 @@ private:
     bool firstItem = true;
 public:
     void startObject() { ss << "{"; firstItem = true; }
-    void endObject() { ss << "}"; }
+    void endObject() { ss << "}"; firstItem = false; }
     void startArray() { ss << "["; firstItem = true; }
-    void endArray() { ss << "]"; }
+    void endArray() { ss << "]"; firstItem = false; }
     void key(const string& k) {
         if (!firstItem) ss << ",";
         ss << "\"" << k << "\":";
         firstItem = false;
     }
     void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
     void value(const string& v) { ss << "\"" << v << "\""; }
     void value(double v) { ss << v; }
     void nextItem() {
@@ -53,11 +62,12 @@ public:
     string str() { return ss.str(); }
 };
 
-int main(int argc, char* argv[]) {
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
     auto startTime = chrono::high_resolution_clock::now();
     
     if (argc < 3) {
-        cout << R"({"code":400,"error":"Insufficient parameters"})";
+        out << R"({"code":400,"error":"Insufficient parameters"})";
         return 1;
     }
     
@@ -80,7 +90,17 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    // A package sums its items' values and a selection takes each item at most once, so every cell stays
+    // within the sum of |v|; the int cells must hold it
+    knapsack_cells::int128 bound = 0;
+    for (const Item& item : items) bound += knapsack_cells::magnitude(item.value);
+    if (bound > INT_MAX) {
+        out << R"({"code":400,"error":"Total value exceeds the int range of the DP"})";
+        return 1;
+    }
+    
     // Generate all valid "package" combinations
+    profiler.enter(PREPROCESS);
     vector<Package> packages;
     
     for (int i = 0; i < n; i++) {
@@ -113,6 +133,7 @@ int main(int argc, char* argv[]) {
     int m = packages.size();
     vector<vector<int>> dp(m + 1, vector<int>(capacity + 1, 0));
     
+    profiler.enter(SERIALIZE);
     JsonBuilder json;
     json.startObject();
     json.key("code"); json.value(200);
@@ -151,86 +172,86 @@ int main(int argc, char* argv[]) {
     }
     json.endArray();
     
+    OpCounters ops;  // Work done by the DP kernel
+    const knapsack_kernels::Kernels& kernels = knapsack_kernels::active();  // Widest ISA of this host
+    profiler.setKernel(kernels.name);
+    
     json.key("steps");
     json.startArray();
     
-    // Convert to 0/1 knapsack for solving
+    // Convert to 0/1 knapsack for solving; compute each row, then emit its steps
     for (int i = 1; i <= m; i++) {
         int w = packages[i - 1].weight;
         int v = packages[i - 1].value;
         
+        profiler.enter(DP);
+        kernels.rowUpdate(dp[i - 1].data(), dp[i].data(), capacity + 1, w, v);
+        
+        ops.cells += capacity + 1;
+        ops.candidates += capacity + 1 + max(0, capacity - w + 1);  // Skip everywhere, take where it fits
+        
+        profiler.enter(SERIALIZE);
         for (int j = 0; j <= capacity; j++) {
             json.nextItem();
             json.startObject();
             json.key("row"); json.value(i);
             json.key("col"); json.value(j);
             json.key("package"); json.value(packages[i - 1].desc);
-            
-            if (j < w) {
-                dp[i][j] = dp[i - 1][j];
-                json.key("val"); json.value(dp[i][j]);
-                json.key("highlight");
-                json.startArray();
-                json.nextItem();
-                json.startObject();
-                json.key("r"); json.value(i - 1);
-                json.key("c"); json.value(j);
-                json.key("type"); json.value("without");
-                json.endObject();
-                json.endArray();
-                json.key("decision"); json.value("skip");
-            } else {
-                int withoutPkg = dp[i - 1][j];
-                int withPkg = dp[i - 1][j - w] + v;
-                dp[i][j] = max(withoutPkg, withPkg);
-                
-                json.key("val"); json.value(dp[i][j]);
-                json.key("highlight");
-                json.startArray();
-                json.nextItem();
-                json.startObject();
-                json.key("r"); json.value(i - 1);
-                json.key("c"); json.value(j);
-                json.key("type"); json.value("without");
-                json.endObject();
+            json.key("val"); json.value(dp[i][j]);
+            json.key("highlight");
+            json.startArray();
+            json.nextItem();
+            json.startObject();
+            json.key("r"); json.value(i - 1);
+            json.key("c"); json.value(j);
+            json.key("type"); json.value("without");
+            json.endObject();
+            if (j >= w) {
                 json.nextItem();
                 json.startObject();
                 json.key("r"); json.value(i - 1);
                 json.key("c"); json.value(j - w);
                 json.key("type"); json.value("with");
                 json.endObject();
-                json.endArray();
-                
-                json.key("decision"); 
-                json.value(dp[i][j] == withoutPkg ? "skip" : "take");
             }
+            json.endArray();
+            
+            json.key("decision"); 
+            json.value(j < w || dp[i][j] == dp[i - 1][j] ? "skip" : "take");
             json.endObject();
         }
     }
     json.endArray();
     
     // Backtrack
-    json.key("path");
-    json.startArray();
+    profiler.enter(RECONSTRUCT);
+    vector<pair<int, int>> path;  // (row, col) of each taken package
     int j = capacity;
     for (int i = m; i > 0 && j > 0; i--) {
         if (dp[i][j] != dp[i - 1][j]) {
-            json.nextItem();
-            json.startObject();
-            json.key("r"); json.value(i);
-            json.key("c"); json.value(j);
-            json.key("package"); json.value(packages[i - 1].desc);
-            json.key("items");
-            json.startArray();
-            for (int idx : packages[i - 1].items) {
-                json.nextItem();
-                json.value(idx);
-            }
-            json.endArray();
-            json.endObject();
+            path.push_back({i, j});
             j -= packages[i - 1].weight;
         }
     }
+    
+    profiler.enter(SERIALIZE);
+    json.key("path");
+    json.startArray();
+    for (auto& [r, c] : path) {
+        json.nextItem();
+        json.startObject();
+        json.key("r"); json.value(r);
+        json.key("c"); json.value(c);
+        json.key("package"); json.value(packages[r - 1].desc);
+        json.key("items");
+        json.startArray();
+        for (int idx : packages[r - 1].items) {
+            json.nextItem();
+            json.value(idx);
+        }
+        json.endArray();
+        json.endObject();
+    }
     json.endArray();
     
     json.key("max_value"); json.value(dp[m][capacity]);
@@ -243,15 +264,27 @@ int main(int argc, char* argv[]) {
     json.startObject();
     json.key("time"); json.value("O(2^k*C)");
     json.key("space"); json.value("O(m*C)");
-    json.key("operations"); json.value(m * (capacity + 1));
-    json.key("memory_bytes"); json.value((m + 1) * (capacity + 1) * 4);
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((long long)(m + 1) * (capacity + 1) * 4);
     json.endObject();
     
-    json.endObject();
-    cout << json.str();
+    // The root object stays open: the profile is appended after the body has been written
+    writeResult(json.str(), profiler, out);
     return 0;
 }
 
+}  // namespace knapsack_depend
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_depend", knapsack_depend::run, argc, argv, cout);
+}
+#endif
+
 
 
 
@@ -0,0 +1,383 @@
+/**
+ * Dynamic 0/1 Knapsack (Insert / Delete / Query)
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description 0/1 knapsack over an item set that changes over time, answering "best value within budget B"
+ *              after any sequence of inserts and deletes.
+ *              offline: segment tree over the query timeline; each item is attached to the O(log Q) nodes
+ *                       covering the queries it is alive for, and a DFS keeps one DP row per depth, so
+ *                       leaving a node rolls back by returning to the parent's row
+ *              online:  stack of prefix DP rows in insertion order; inserts and deletes are only recorded,
+ *                       and the next query rebuilds once from the lowest changed row. Deleting the item at
+ *                       stack position p costs the next query n - p rows, so a stream that keeps deleting
+ *                       old items between queries is O(n*C) per operation. Before solving, the rebuilds are
+ *                       counted (no DP) and a stream that would rebuild more rows than the offline tree
+ *                       builds (its attachments plus one row per tree node) is solved offline instead, which
+ *                       bounds both modes by O(C*(n*log(Q) + Q))
+ *              Rows hold the best value with weight <= j, so each query is a single lookup
+ *
+ * Input: Command line arguments, <capacity> <mode> <m> followed by m operations
+ *        (+w,v insert an item, ids count up from 0 in insertion order   -id delete item id   ?B query budget B)
+ * Output: Standard output in JSON format (no animation steps, one answer per query)
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+
+using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_dynamic {
+
+struct Item {
+    int weight;
+    int value;
+    int inserted;  // Operation index
+    int deleted;   // Operation index, -1 while alive at the end
+};
+
+struct Query {
+    int time;  // Operation index
+    int budget;
+    int alive;
+    long long value;
+};
+
+enum OpType { INSERT, DELETE, QUERY };
+
+struct Op {
+    OpType type;
+    int arg;  // Item id for insert/delete, budget for query
+};
+
+class JsonBuilder {
+private:
+    stringstream ss;
+    bool firstItem = true;
+
+public:
+    void startObject() { ss << "{"; firstItem = true; }
+    void endObject() { ss << "}"; firstItem = false; }
+    void startArray() { ss << "["; firstItem = true; }
+    void endArray() { ss << "]"; firstItem = false; }
+
+    void key(const string& k) {
+        if (!firstItem) ss << ",";
+        ss << "\"" << k << "\":";
+        firstItem = false;
+    }
+
+    void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
+    void value(const string& v) { ss << "\"" << v << "\""; }
+    void value(double v) { ss << v; }
+
+    void nextItem() {
+        if (!firstItem) ss << ",";
+        firstItem = false;
+    }
+
+    string str() { return ss.str(); }
+};
+
+// Add one item to a best-within-weight row
+void addItem(vector<long long>& row, const Item& item, int capacity, OpCounters& ops) {
+    for (int j = capacity; j >= item.weight; j--) {
+        row[j] = max(row[j], row[j - item.weight] + item.value);
+    }
+    ops.cells += max(0, capacity - item.weight + 1);
+    ops.candidates += max(0, capacity - item.weight + 1);
+}
+
+class OfflineSolver {
+private:
+    int capacity;
+    const vector<Item>& items;
+    vector<Query>& queries;
+    OpCounters& ops;
+    vector<vector<int>> nodeItems;
+    vector<vector<long long>> rows;  // rows[d] is the DP row at depth d of the DFS
+
+    void attach(int node, int l, int r, int ql, int qr, int id) {
+        if (qr < l || r < ql) return;
+        if (ql <= l && r <= qr) {
+            nodeItems[node].push_back(id);
+            ops.merges++;
+            return;
+        }
+        int mid = (l + r) / 2;
+        attach(node * 2, l, mid, ql, qr, id);
+        attach(node * 2 + 1, mid + 1, r, ql, qr, id);
+    }
+
+    void dfs(int node, int l, int r, int depth) {
+        if ((int)rows.size() <= depth + 1) rows.emplace_back(capacity + 1, 0);
+        vector<long long>& row = rows[depth + 1];
+        row = rows[depth];
+        for (int id : nodeItems[node]) addItem(row, items[id], capacity, ops);
+        if (l == r) {
+            queries[l].value = row[queries[l].budget];
+            return;
+        }
+        int mid = (l + r) / 2;
+        dfs(node * 2, l, mid, depth + 1);
+        dfs(node * 2 + 1, mid + 1, r, depth + 1);
+    }
+
+public:
+    OfflineSolver(int capacity, const vector<Item>& items, vector<Query>& queries, OpCounters& ops)
+        : capacity(capacity), items(items), queries(queries), ops(ops) {}
+
+    size_t rowCount() const { return rows.size(); }
+
+    void build(int opCount) {
+        int q = (int)queries.size();
+        nodeItems.assign(4 * max(1, q), {});
+        // queriesBefore[t] = number of queries with operation index < t
+        vector<int> queriesBefore(opCount + 1, 0);
+        for (const Query& query : queries) queriesBefore[query.time + 1]++;
+        for (int t = 0; t < opCount; t++) queriesBefore[t + 1] += queriesBefore[t];
+
+        for (int id = 0; id < (int)items.size(); id++) {
+            int first = queriesBefore[items[id].inserted];
+            int last = (items[id].deleted < 0 ? q : queriesBefore[items[id].deleted]) - 1;
+            if (first <= last) attach(1, 0, q - 1, first, last, id);
+        }
+    }
+
+    void solve() {
+        if (queries.empty()) return;
+        rows.assign(1, vector<long long>(capacity + 1, 0));
+        dfs(1, 0, (int)queries.size() - 1, 0);
+    }
+};
+
+// Rows the online solver would rebuild over the timeline. The stack is the alive items in id (= insertion)
+// order, so an item's stack position is the number of alive items with a smaller id
+long long onlineRebuildRows(const vector<Op>& timeline, int itemCount) {
+    vector<int> alive(itemCount + 1, 0);  // Fenwick tree over item ids
+    auto add = [&](int id, int delta) {
+        for (int i = id + 1; i <= itemCount; i += i & -i) alive[i] += delta;
+    };
+    auto below = [&](int id) {
+        int count = 0;
+        for (int i = id; i > 0; i -= i & -i) count += alive[i];
+        return count;
+    };
+    long long rows = 0;
+    int size = 0, valid = 0;
+    for (const Op& op : timeline) {
+        if (op.type == INSERT) {
+            add(op.arg, 1);
+            size++;
+        } else if (op.type == DELETE) {
+            valid = min(valid, below(op.arg));
+            add(op.arg, -1);
+            size--;
+        } else {
+            rows += size - valid;
+            valid = size;
+        }
+    }
+    return rows;
+}
+
+class OnlineSolver {
+private:
+    int capacity;
+    const vector<Item>& items;
+    OpCounters& ops;
+    vector<int> stack;               // Alive items in insertion order
+    vector<vector<long long>> rows;  // rows[k] covers stack[0..k-1]
+    size_t valid = 0;                // rows[0..valid] are up to date
+
+public:
+    OnlineSolver(int capacity, const vector<Item>& items, OpCounters& ops)
+        : capacity(capacity), items(items), ops(ops), rows(1, vector<long long>(capacity + 1, 0)) {}
+
+    size_t rowCount() const { return rows.size(); }
+
+    void insert(int id) { stack.push_back(id); }
+
+    void erase(int id) {
+        size_t p = find(stack.begin(), stack.end(), id) - stack.begin();
+        stack.erase(stack.begin() + p);
+        valid = min(valid, p);
+    }
+
+    // Every edit since the last query is paid for by one rebuild from the lowest changed row
+    long long query(int budget) {
+        if (rows.size() < stack.size() + 1) rows.resize(stack.size() + 1, vector<long long>(capacity + 1, 0));
+        for (size_t k = valid + 1; k <= stack.size(); k++) {
+            rows[k] = rows[k - 1];
+            addItem(rows[k], items[stack[k - 1]], capacity, ops);
+            ops.merges++;
+        }
+        valid = stack.size();
+        return rows[valid][budget];
+    }
+};
+
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
+    auto startTime = chrono::high_resolution_clock::now();
+
+    // Format: knapsack_dynamic.exe <capacity> <offline|online> <m> <op1> <op2> ...
+    if (argc < 4) {
+        out << R"({"code":400,"error":"Insufficient parameters"})";
+        return 1;
+    }
+
+    int capacity = stoi(argv[1]);
+    string mode = argv[2];
+    int m = stoi(argv[3]);
+
+    if (mode != "offline" && mode != "online") {
+        out << R"({"code":400,"error":"Unknown mode, expected offline or online"})";
+        return 1;
+    }
+
+    vector<Item> items;
+    vector<Query> queries;
+    vector<Op> timeline;
+    int alive = 0;
+    for (int t = 0; t < m && t + 4 < argc; t++) {
+        string arg = argv[t + 4];
+        if (arg.size() < 2) {
+            out << R"({"code":400,"error":"Invalid operation"})";
+            return 1;
+        }
+        if (arg[0] == '+') {
+            size_t comma = arg.find(',');
+            items.push_back({stoi(arg.substr(1, comma - 1)), stoi(arg.substr(comma + 1)), t, -1});
+            if (items.back().weight < 0) {
+                out << R"({"code":400,"error":"Negative weight"})";
+                return 1;
+            }
+            timeline.push_back({INSERT, (int)items.size() - 1});
+            alive++;
+        } else if (arg[0] == '-') {
+            int id = stoi(arg.substr(1));
+            if (id < 0 || id >= (int)items.size() || items[id].deleted >= 0) {
+                out << R"({"code":400,"error":"Delete of an item that is not alive"})";
+                return 1;
+            }
+            items[id].deleted = t;
+            timeline.push_back({DELETE, id});
+            alive--;
+        } else if (arg[0] == '?') {
+            int budget = stoi(arg.substr(1));
+            if (budget < 0 || budget > capacity) {
+                out << R"({"code":400,"error":"Query budget outside 0..capacity"})";
+                return 1;
+            }
+            queries.push_back({t, budget, alive, 0});
+            timeline.push_back({QUERY, budget});
+        } else {
+            out << R"({"code":400,"error":"Invalid operation"})";
+            return 1;
+        }
+    }
+
+    OpCounters ops;  // merges: (item, tree node) attachments offline, rows rebuilt online
+    size_t rowCount = 0;
+    string solvedBy = mode;
+    profiler.enter(PREPROCESS);
+    if (mode == "online") {
+        // Delete-heavy streams go to the segment tree when its rows are fewer than the online rebuilds
+        OpCounters planned;
+        OfflineSolver tree(capacity, items, queries, planned);
+        tree.build((int)timeline.size());
+        long long treeRows = planned.merges + max(0LL, 2 * (long long)queries.size() - 1);
+        if (onlineRebuildRows(timeline, (int)items.size()) > treeRows) solvedBy = "offline";
+    }
+    if (solvedBy == "offline") {
+        OfflineSolver solver(capacity, items, queries, ops);
+        solver.build((int)timeline.size());
+        profiler.enter(DP);
+        solver.solve();
+        rowCount = solver.rowCount();
+    } else {
+        profiler.enter(DP);
+        OnlineSolver solver(capacity, items, ops);
+        size_t q = 0;
+        for (const Op& op : timeline) {
+            if (op.type == INSERT) solver.insert(op.arg);
+            else if (op.type == DELETE) solver.erase(op.arg);
+            else queries[q++].value = solver.query(op.arg);
+        }
+        rowCount = solver.rowCount();
+    }
+    profiler.setDpCells(ops.cells);
+
+    profiler.enter(SERIALIZE);
+    JsonBuilder json;
+    json.startObject();
+    json.key("code"); json.value(200);
+    json.key("type"); json.value("Dynamic 0/1 Knapsack");
+    json.key("mode"); json.value(mode);
+    json.key("solved_by"); json.value(solvedBy);
+    json.key("capacity"); json.value(capacity);
+
+    json.key("items");
+    json.startArray();
+    for (const Item& item : items) {
+        json.nextItem();
+        json.startObject();
+        json.key("w"); json.value(item.weight);
+        json.key("v"); json.value(item.value);
+        json.key("inserted"); json.value(item.inserted);
+        json.key("deleted"); json.value(item.deleted);
+        json.endObject();
+    }
+    json.endArray();
+
+    json.key("queries");
+    json.startArray();
+    for (const Query& query : queries) {
+        json.nextItem();
+        json.startObject();
+        json.key("t"); json.value(query.time);
+        json.key("budget"); json.value(query.budget);
+        json.key("alive"); json.value(query.alive);
+        json.key("value"); json.value(query.value);
+        json.endObject();
+    }
+    json.endArray();
+
+    json.key("max_value"); json.value(queries.empty() ? 0LL : queries.back().value);
+
+    auto endTime = chrono::high_resolution_clock::now();
+    double duration = chrono::duration<double, milli>(endTime - startTime).count();
+    json.key("time_ms"); json.value(duration);
+
+    json.key("complexity");
+    json.startObject();
+    json.key("time"); json.value(solvedBy == "offline" ? "O(C*(n*log(Q)+Q))" : "O(C*rebuilt rows)");
+    json.key("space"); json.value(solvedBy == "offline" ? "O(C*log(Q))" : "O(n*C)");
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((long long)rowCount * (capacity + 1) * 8);
+    json.endObject();
+
+    writeResult(json.str(), profiler, out);
+    return 0;
+}
+
+}  // namespace knapsack_dynamic
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_dynamic", knapsack_dynamic::run, argc, argv, cout);
+}
+#endif
@@ -0,0 +1,270 @@
+/**
+ * 0/1 Knapsack Problem Algorithm (FPTAS)
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Fully polynomial-time approximation scheme for 0/1 knapsack: values are scaled down by
+ *              K = eps * vmax / n and a value-indexed min-weight DP is solved on the scaled values.
+ *              The selection is guaranteed to be at least (1 - eps) times the optimum, in O(n^3 / eps) time
+ *              independent of the capacity
+ *
+ * Input: Command line arguments in JSON format
+ * Output: Standard output in JSON format (no animation steps, the path lists the chosen items)
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <climits>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_cells.h"
+
+using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_fptas {
+
+struct Item {
+    long long weight;
+    long long value;
+};
+
+class JsonBuilder {
+private:
+    stringstream ss;
+    bool firstItem = true;
+
+public:
+    void startObject() { ss << "{"; firstItem = true; }
+    void endObject() { ss << "}"; firstItem = false; }
+    void startArray() { ss << "["; firstItem = true; }
+    void endArray() { ss << "]"; firstItem = false; }
+
+    void key(const string& k) {
+        if (!firstItem) ss << ",";
+        ss << "\"" << k << "\":";
+        firstItem = false;
+    }
+
+    void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
+    void value(const string& v) { ss << "\"" << v << "\""; }
+    void value(double v) { ss << v; }
+
+    void nextItem() {
+        if (!firstItem) ss << ",";
+        firstItem = false;
+    }
+
+    string str() { return ss.str(); }
+};
+
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
+    auto startTime = chrono::high_resolution_clock::now();
+
+    // Format: knapsack_fptas.exe <capacity> <epsilon> <n> <w1,v1> <w2,v2> ...
+    if (argc < 4) {
+        out << R"({"code":400,"error":"Insufficient parameters"})";
+        return 1;
+    }
+
+    long long capacity = stoll(argv[1]);
+    double eps = stod(argv[2]);
+    int n = stoi(argv[3]);
+
+    if (!(eps > 0 && eps < 1)) {
+        out << R"({"code":400,"error":"Epsilon must be between 0 and 1"})";
+        return 1;
+    }
+
+    vector<Item> items(n);
+    for (int i = 0; i < n && i + 4 < argc; i++) {
+        string arg = argv[i + 4];
+        size_t comma = arg.find(',');
+        items[i].weight = stoll(arg.substr(0, comma));
+        items[i].value = stoll(arg.substr(comma + 1));
+    }
+
+    // The achieved and the fitting totals are long long sums of the values
+    knapsack_cells::int128 bound = 0;
+    for (const Item& item : items) bound += knapsack_cells::magnitude(item.value);
+    if (bound > LLONG_MAX) {
+        out << R"({"code":400,"error":"Total value exceeds the 64-bit range of the DP"})";
+        return 1;
+    }
+
+    // Items that never fit do not take part in the scaling
+    profiler.enter(PREPROCESS);
+    vector<int> candidates;
+    long long vmax = 0;
+    for (int i = 0; i < n; i++) {
+        if (items[i].weight <= capacity && items[i].value > 0) {
+            candidates.push_back(i);
+            vmax = max(vmax, items[i].value);
+        }
+    }
+    int m = candidates.size();
+
+    // Scale factor; below 1 the scaled instance is the exact one
+    double scale = m > 0 ? max(1.0, eps * vmax / m) : 1.0;
+    vector<long long> scaled(m);
+    long long scaledSum = 0;
+    for (int i = 0; i < m; i++) {
+        scaled[i] = (long long)floor(items[candidates[i]].value / scale);
+        scaledSum += scaled[i];
+    }
+
+    // minWeight[p] = minimum weight reaching scaled value exactly p;
+    // took[i][p] records whether item i improved cell p, for reconstruction
+    profiler.enter(DP);
+    const long long INF = LLONG_MAX;
+    vector<long long> minWeight(scaledSum + 1, INF);
+    minWeight[0] = 0;
+    vector<vector<bool>> took(m, vector<bool>(scaledSum + 1, false));
+    long long reach = 0;  // Largest scaled value reachable so far
+    OpCounters ops;
+    ops.pruned += n - m;  // Items that never fit or carry no value
+    for (int i = 0; i < m; i++) {
+        long long w = items[candidates[i]].weight;
+        long long sv = scaled[i];
+        if (sv == 0) {
+            ops.pruned++;  // Rounded away by the scaling
+            continue;
+        }
+        long long unreachable = 0;
+        for (long long p = reach; p >= 0; p--) {
+            if (minWeight[p] == INF) {
+                unreachable++;
+                continue;
+            }
+            long long nw = minWeight[p] + w;
+            if (nw <= capacity && nw < minWeight[p + sv]) {
+                minWeight[p + sv] = nw;
+                took[i][p + sv] = true;
+            }
+        }
+        ops.cells += reach + 1;
+        ops.candidates += reach + 1 - unreachable;
+        ops.pruned += unreachable;
+        reach = min(scaledSum, reach + sv);
+    }
+
+    long long bestScaled = 0;
+    for (long long p = scaledSum; p >= 0; p--) {
+        if (minWeight[p] <= capacity) {
+            bestScaled = p;
+            break;
+        }
+    }
+
+    // Reconstruct: walk items backwards, each took[i][p] jumps to p - scaled[i]
+    profiler.enter(RECONSTRUCT);
+    vector<bool> chosen(n, false);
+    long long p = bestScaled;
+    for (int i = m - 1; i >= 0 && p > 0; i--) {
+        if (took[i][p]) {
+            chosen[candidates[i]] = true;
+            p -= scaled[i];
+        }
+    }
+
+    long long achieved = 0;
+    for (int i = 0; i < n; i++) {
+        if (chosen[i]) achieved += items[i].value;
+    }
+
+    // Each chosen item loses less than one scale unit, so OPT <= achieved + m * scale
+    // (and trivially OPT <= sum of fitting values); the exact case has zero slack
+    long long fittingSum = 0;
+    for (int idx : candidates) fittingSum += items[idx].value;
+    double upperBound = scale > 1.0 ? min((double)fittingSum, achieved + m * scale) : (double)achieved;
+    double ratio = upperBound > 0 ? achieved / upperBound : 1.0;
+
+    profiler.enter(SERIALIZE);
+    JsonBuilder json;
+    json.startObject();
+
+    json.key("code"); json.value(200);
+    json.key("type"); json.value("0/1 Knapsack (FPTAS)");
+    json.key("capacity"); json.value(capacity);
+
+    json.key("items");
+    json.startArray();
+    for (int i = 0; i < n; i++) {
+        json.nextItem();
+        json.startObject();
+        json.key("w"); json.value(items[i].weight);
+        json.key("v"); json.value(items[i].value);
+        json.endObject();
+    }
+    json.endArray();
+
+    json.key("steps");
+    json.startArray();
+    json.endArray();
+
+    json.key("path");
+    json.startArray();
+    long long j = capacity;
+    for (int i = n; i > 0; i--) {
+        if (chosen[i - 1]) {
+            json.nextItem();
+            json.startObject();
+            json.key("r"); json.value(i);
+            json.key("c"); json.value(j);
+            json.key("item"); json.value(i - 1);
+            json.endObject();
+            j -= items[i - 1].weight;
+        }
+    }
+    json.endArray();
+
+    json.key("max_value"); json.value(achieved);
+
+    // Approximation report
+    json.key("approximation");
+    json.startObject();
+    json.key("epsilon"); json.value(eps);
+    json.key("scale"); json.value(scale);
+    json.key("exact"); json.value(scale > 1.0 ? 0 : 1);
+    json.key("scaled_value_sum"); json.value(scaledSum);
+    json.key("table_cells"); json.value((long long)m * (scaledSum + 1));
+    json.key("guarantee"); json.value(1.0 - eps);
+    json.key("optimum_upper_bound"); json.value(upperBound);
+    json.key("achieved_ratio"); json.value(ratio);
+    json.endObject();
+
+    auto endTime = chrono::high_resolution_clock::now();
+    double duration = chrono::duration<double, milli>(endTime - startTime).count();
+    json.key("time_ms"); json.value(duration);
+
+    json.key("complexity");
+    json.startObject();
+    json.key("time"); json.value("O(n^3/eps)");
+    json.key("space"); json.value("O(n^3/eps)");
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((long long)(scaledSum + 1) * 8 + (long long)m * (scaledSum + 1) / 8);
+    json.endObject();
+
+    writeResult(json.str(), profiler, out);
+
+    return 0;
+}
+
+}  // namespace knapsack_fptas
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_fptas", knapsack_fptas::run, argc, argv, cout);
+}
+#endif
@@ -11,10 +11,19 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <climits>
 #include <map>
 #include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_cells.h"
+#include "knapsack_trace_codec.h"
+#include "row_store.h"
 
 using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_group {
 
 struct Item {
     int weight;
@@ -29,17 +38,19 @@ private:
     bool firstItem = true;
 public:
     void startObject() { ss << "{"; firstItem = true; }
-    void endObject() { ss << "}"; }
+    void endObject() { ss << "}"; firstItem = false; }
     void startArray() { ss << "["; firstItem = true; }
-    void endArray() { ss << "]"; }
+    void endArray() { ss << "]"; firstItem = false; }
     void key(const string& k) {
         if (!firstItem) ss << ",";
         ss << "\"" << k << "\":";
         firstItem = false;
     }
     void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
     void value(const string& v) { ss << "\"" << v << "\""; }
     void value(double v) { ss << v; }
+    void raw(const string& v) { ss << v; }
     void nextItem() {
         if (!firstItem) ss << ",";
         firstItem = false;
@@ -47,11 +58,12 @@ public:
     string str() { return ss.str(); }
 };
 
-int main(int argc, char* argv[]) {
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
     auto startTime = chrono::high_resolution_clock::now();
     
     if (argc < 3) {
-        cout << R"({"code":400,"error":"Insufficient parameters"})";
+        out << R"({"code":400,"error":"Insufficient parameters"})";
         return 1;
     }
     
@@ -72,14 +84,30 @@ int main(int argc, char* argv[]) {
         groups[items[i].group].push_back(i);
     }
     
+    // At most one item per group: cells stay within the sum of the groups' largest |v|, which must fit an int
+    knapsack_cells::int128 bound = 0;
+    for (auto& g : groups) {
+        knapsack_cells::int128 best = 0;
+        for (int idx : g.second) best = max(best, knapsack_cells::magnitude(items[idx].value));
+        bound += best;
+    }
+    if (bound > INT_MAX) {
+        out << R"({"code":400,"error":"Total value exceeds the int range of the DP"})";
+        return 1;
+    }
+    
     int numGroups = groups.size();
     vector<int> groupIds;
     for (auto& p : groups) {
         groupIds.push_back(p.first);
     }
     
-    vector<vector<int>> dp(numGroups + 1, vector<int>(capacity + 1, 0));
+    profiler.enter(PREPROCESS);
+    knapsack_rows::RowStore<int> dp(numGroups + 1, capacity + 1, "knapsack_group");  // In memory or mapped
+    const bool omitted = knapsack_trace::stepsOmitted(argc, argv);  // --trace=none
+    vector<int> bestChoice(capacity + 1);  // Chosen item per column of the current group, -1 = none
     
+    profiler.enter(SERIALIZE);
     JsonBuilder json;
     json.startObject();
     json.key("code"); json.value(200);
@@ -116,29 +144,53 @@ int main(int argc, char* argv[]) {
     }
     json.endArray();
     
-    json.key("steps");
-    json.startArray();
+    OpCounters ops;  // Work done by the DP kernel
     
-    // Group knapsack DP
+    if (!omitted) {
+        json.key("steps");
+        json.startArray();
+    }
+    
+    // Group knapsack DP: compute each group's row, then emit its steps
     for (int g = 0; g < numGroups; g++) {
         int gid = groupIds[g];
         vector<int>& groupItems = groups[gid];
         
+        profiler.enter(DP);
         for (int j = 0; j <= capacity; j++) {
             // First inherit value from previous group
             dp[g + 1][j] = dp[g][j];
-            int bestChoice = -1;  // -1 means not selected
+            bestChoice[j] = -1;  // -1 means not selected
             
             // Try selecting each item in group
+            for (int idx : groupItems) {
+                int w = items[idx].weight;
+                int v = items[idx].value;
+                if (j >= w && dp[g][j - w] + v > dp[g + 1][j]) {
+                    dp[g + 1][j] = dp[g][j - w] + v;
+                    bestChoice[j] = idx;
+                }
+            }
+        }
+        
+        ops.cells += capacity + 1;
+        ops.candidates += capacity + 1;
+        for (int idx : groupItems) ops.candidates += max(0, capacity - items[idx].weight + 1);
+        dp.rowDone(g + 1);
+        
+        if (omitted) continue;
+        profiler.enter(SERIALIZE);
+        for (int j = 0; j <= capacity; j++) {
             json.nextItem();
             json.startObject();
             json.key("row"); json.value(g + 1);
             json.key("col"); json.value(j);
             json.key("groupId"); json.value(gid);
             
+            // Replay the tries against the running best of this cell
             json.key("tryItems");
             json.startArray();
-            
+            int running = dp[g][j];
             for (int idx : groupItems) {
                 int w = items[idx].weight;
                 int v = items[idx].value;
@@ -149,11 +201,10 @@ int main(int argc, char* argv[]) {
                 json.key("w"); json.value(w);
                 json.key("v"); json.value(v);
                 
-                if (j >= w && dp[g][j - w] + v > dp[g + 1][j]) {
-                    dp[g + 1][j] = dp[g][j - w] + v;
-                    bestChoice = idx;
+                if (j >= w && dp[g][j - w] + v > running) {
+                    running = dp[g][j - w] + v;
                     json.key("canTake"); json.value(1);
-                    json.key("newVal"); json.value(dp[g + 1][j]);
+                    json.key("newVal"); json.value(running);
                 } else {
                     json.key("canTake"); json.value(j >= w ? 1 : 0);
                     json.key("newVal"); json.value(j >= w ? dp[g][j - w] + v : 0);
@@ -163,7 +214,7 @@ int main(int argc, char* argv[]) {
             json.endArray();
             
             json.key("val"); json.value(dp[g + 1][j]);
-            json.key("bestChoice"); json.value(bestChoice);
+            json.key("bestChoice"); json.value(bestChoice[j]);
             
             json.key("highlight");
             json.startArray();
@@ -173,46 +224,58 @@ int main(int argc, char* argv[]) {
             json.key("c"); json.value(j);
             json.key("type"); json.value("without");
             json.endObject();
-            if (bestChoice >= 0) {
+            if (bestChoice[j] >= 0) {
                 json.nextItem();
                 json.startObject();
                 json.key("r"); json.value(g);
-                json.key("c"); json.value(j - items[bestChoice].weight);
+                json.key("c"); json.value(j - items[bestChoice[j]].weight);
                 json.key("type"); json.value("with");
                 json.endObject();
             }
             json.endArray();
             
             json.key("decision"); 
-            json.value(bestChoice >= 0 ? "take" : "skip");
+            json.value(bestChoice[j] >= 0 ? "take" : "skip");
             
             json.endObject();
         }
     }
-    json.endArray();
+    if (!omitted) json.endArray();
+    
+    profiler.setDpCells(ops.candidates);
     
     // Backtrack
-    json.key("path");
-    json.startArray();
+    profiler.enter(RECONSTRUCT);
+    vector<pair<int, int>> path;  // (group row, column) of each chosen item
+    vector<int> pathItems;
     int j = capacity;
     for (int g = numGroups - 1; g >= 0 && j > 0; g--) {
+        dp.reading(g);
         int gid = groupIds[g];
         for (int idx : groups[gid]) {
             int w = items[idx].weight;
             int v = items[idx].value;
             if (j >= w && dp[g + 1][j] == dp[g][j - w] + v) {
-                json.nextItem();
-                json.startObject();
-                json.key("r"); json.value(g + 1);
-                json.key("c"); json.value(j);
-                json.key("item"); json.value(idx);
-                json.key("group"); json.value(gid);
-                json.endObject();
+                path.push_back({g + 1, j});
+                pathItems.push_back(idx);
                 j -= w;
                 break;
             }
         }
     }
+    
+    profiler.enter(SERIALIZE);
+    json.key("path");
+    json.startArray();
+    for (size_t p = 0; p < path.size(); p++) {
+        json.nextItem();
+        json.startObject();
+        json.key("r"); json.value(path[p].first);
+        json.key("c"); json.value(path[p].second);
+        json.key("item"); json.value(pathItems[p]);
+        json.key("group"); json.value(groupIds[path[p].first - 1]);
+        json.endObject();
+    }
     json.endArray();
     
     json.key("max_value"); json.value(dp[numGroups][capacity]);
@@ -225,15 +288,30 @@ int main(int argc, char* argv[]) {
     json.startObject();
     json.key("time"); json.value("O(G*C*K)");
     json.key("space"); json.value("O(G*C)");
-    json.key("operations"); json.value(numGroups * (capacity + 1) * (n / numGroups));
-    json.key("memory_bytes"); json.value((numGroups + 1) * (capacity + 1) * 4);
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((long long)(numGroups + 1) * (capacity + 1) * 4);
     json.endObject();
+    if (dp.mapped()) {
+        json.key("row_store"); json.raw(dp.json());
+    }
     
-    json.endObject();
-    cout << json.str();
+    // The root object stays open: the profile is appended after the body has been written
+    writeResult(json.str(), profiler, out);
     return 0;
 }
 
+}  // namespace knapsack_group
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_group", knapsack_group::run, argc, argv, cout);
+}
+#endif
+
 
 
 
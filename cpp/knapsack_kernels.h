@@ -0,0 +1,251 @@
+/**
+ * Runtime-Dispatched DP Kernels
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description The hot inner loops shared by the solvers, compiled once per x86-64 ISA level and picked at
+ *              startup from cpuid (__builtin_cpu_supports), so one binary uses the widest vector unit of
+ *              whatever host it runs on:
+ *                rowUpdate     0/1 row: cur[j] = max(prev[j], prev[j - w] + v)
+ *                pairUpdate    0/1 row of a 2-D plane: cur[k] = max(prev[k], other[k - m] + v), other = row j - w
+ *                unboundedRow  complete-knapsack row in place: row[j] = max(row[j], row[j - w] + v), j rising
+ *                maxPlusMerge  in-place max-plus convolution of a child row into a parent row (tree)
+ *                mergeTopK     top-K merge of two descending lists, one shifted by a value (k-th best)
+ *              Variants: x86-64 (SSE2), x86-64-v2 (SSE4.2), x86-64-v3 (AVX2), x86-64-v4 (AVX-512).
+ *              KNAPSACK_ISA=<variant> caps the choice, e.g. to compare variants on one machine.
+ *              The two row kernels and the max-plus merge also exist per DP cell type (knapsack_cells.h)
+ *              through rowKernels<T>(), so a uint16 table fills twice the lanes of an int one and an int64
+ *              table does not overflow.
+ *              Other compilers and architectures get the portable variant only ("generic")
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#include "knapsack_cells.h"
+
+namespace knapsack_kernels {
+
+struct Kernels {
+    const char* name;
+    void (*rowUpdate)(const int* prev, int* cur, int cols, int w, int v);
+    void (*pairUpdate)(const int* prev, const int* other, int* cur, int cols, int m, int v);
+    void (*unboundedRow)(int* row, int cols, int w, int v);
+    void (*maxPlusMerge)(int* dst, const int* child, int lo, int capacity);
+    size_t (*mergeTopK)(const int* a, size_t na, const int* b, size_t nb, int add, int* out, size_t k);
+};
+
+// The row kernels of one variant for another cell type
+template <class T>
+struct RowKernels {
+    const char* name;
+    void (*rowUpdate)(const T* prev, T* cur, int cols, int w, T v);
+    void (*unboundedRow)(T* row, int cols, int w, T v);
+    void (*maxPlusMerge)(T* dst, const T* child, int lo, int capacity);
+};
+
+#if defined(__GNUC__)
+#define KNAPSACK_KERNEL_INLINE __attribute__((always_inline)) inline
+#else
+#define KNAPSACK_KERNEL_INLINE inline
+#endif
+
+// Portable bodies; each variant inlines them under its own target so the loops vectorize for it
+namespace body {
+
+// The sum is narrowed back to T before the max, so uint16 and int64 rows vectorize in their own lane width
+template <class T>
+KNAPSACK_KERNEL_INLINE void rowUpdate(const T* prev, T* cur, int cols, int w, T v) {
+    int split = std::min(w, cols);
+    std::memcpy(cur, prev, (size_t)split * sizeof(T));  // Cannot fit: inherit
+    for (int j = split; j < cols; j++) cur[j] = std::max(prev[j], (T)(prev[j - w] + v));
+}
+
+// Same as rowUpdate, with the shifted operand taken from another row
+KNAPSACK_KERNEL_INLINE void pairUpdate(const int* prev, const int* other, int* cur, int cols, int m, int v) {
+    int split = std::min(m, cols);
+    std::memcpy(cur, prev, (size_t)split * sizeof(int));
+    for (int k = split; k < cols; k++) cur[k] = std::max(prev[k], other[k - m] + v);
+}
+
+// The forward dependency on row[j - w] only reaches back one stride, so each block of `stride` cells reads
+// nothing but the finished block before it and has no loop-carried dependency of its own. Strides shorter
+// than a vector are first doubled: a top-down pass with stride s (reading values not yet updated) lets
+// every cell take up to 2s/w - 1 copies, and the blocked pass then adds copies s at a time. A vector is
+// at most 64 bytes, so the shortest useful stride depends on the cell size
+template <class T>
+KNAPSACK_KERNEL_INLINE void unboundedRow(T* row, int cols, int w, T v) {
+    constexpr int minStride = 64 / sizeof(T) > 1 ? (int)(64 / sizeof(T)) : 1;
+    if (w <= 0 || w >= cols) return;
+    int stride = w;
+    T gain = v;
+    while (stride < minStride && stride < cols) {
+        for (int j = cols - 1; j >= stride; j--) row[j] = std::max(row[j], (T)(row[j - stride] + gain));
+        stride *= 2;
+        if (stride < cols) gain *= 2;  // Only a stride below cols is used, and then gain = v * stride / w <= the bound
+    }
+    for (int block = stride; block < cols; block += stride) {
+        int end = std::min(block + stride, cols);
+        for (int j = block; j < end; j++) row[j] = std::max(row[j], (T)(row[j - stride] + gain));
+    }
+}
+
+// dst[j] = max over k of dst[j - k] + child[k], for j >= lo and k <= j - lo. Columns are finished from the
+// top, so every dst[j - k] with k > 0 read for column j is still the value before the merge
+template <class T>
+KNAPSACK_KERNEL_INLINE void maxPlusMerge(T* dst, const T* child, int lo, int capacity) {
+    for (int j = capacity; j >= lo; j--) {
+        T best = dst[j];
+        for (int k = 0; k <= j - lo; k++) best = std::max(best, (T)(dst[j - k] + child[k]));
+        dst[j] = best;
+    }
+}
+
+// Ties go to a, like the scalar merge it replaces
+KNAPSACK_KERNEL_INLINE size_t mergeTopK(const int* a, size_t na, const int* b, size_t nb, int add, int* out,
+                                        size_t k) {
+    size_t i = 0, j = 0, n = 0;
+    while (n < k && i < na && j < nb) {
+        int x = a[i], y = b[j] + add;
+        bool fromA = x >= y;
+        out[n++] = fromA ? x : y;
+        i += fromA;
+        j += !fromA;
+    }
+    for (; n < k && i < na; i++) out[n++] = a[i];
+    for (; n < k && j < nb; j++) out[n++] = b[j] + add;
+    return n;
+}
+
+}  // namespace body
+
+// One set of entry points per variant, each compiled for its target
+#define KNAPSACK_KERNEL_VARIANT(NS, ATTR)                                                                       \
+    namespace NS {                                                                                              \
+    template <class T>                                                                                          \
+    ATTR inline void rowUpdate(const T* prev, T* cur, int cols, int w, T v) {                                   \
+        body::rowUpdate(prev, cur, cols, w, v);                                                                 \
+    }                                                                                                           \
+    ATTR inline void pairUpdate(const int* prev, const int* other, int* cur, int cols, int m, int v) {          \
+        body::pairUpdate(prev, other, cur, cols, m, v);                                                         \
+    }                                                                                                           \
+    template <class T>                                                                                          \
+    ATTR inline void unboundedRow(T* row, int cols, int w, T v) {                                               \
+        body::unboundedRow(row, cols, w, v);                                                                    \
+    }                                                                                                           \
+    template <class T>                                                                                          \
+    ATTR inline void maxPlusMerge(T* dst, const T* child, int lo, int capacity) {                              \
+        body::maxPlusMerge(dst, child, lo, capacity);                                                           \
+    }                                                                                                           \
+    ATTR inline size_t mergeTopK(const int* a, size_t na, const int* b, size_t nb, int add, int* out, size_t k) { \
+        return body::mergeTopK(a, na, b, nb, add, out, k);                                                      \
+    }                                                                                                           \
+    }
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KNAPSACK_KERNEL_DISPATCH 1
+// -O2 only vectorizes loops whose trip count needs no scalar epilogue; the kernels ask for the full model
+#define KNAPSACK_KERNEL_TARGET(ISA) \
+    __attribute__((target(ISA), optimize("tree-vectorize", "vect-cost-model=dynamic")))
+KNAPSACK_KERNEL_VARIANT(x86_64, __attribute__((optimize("tree-vectorize", "vect-cost-model=dynamic"))))
+KNAPSACK_KERNEL_VARIANT(x86_64_v2, KNAPSACK_KERNEL_TARGET("sse4.2,popcnt"))
+// MinGW cannot align the stack beyond 16 bytes, so spilled AVX registers would fault: no v3/v4 on Windows
+#ifndef _WIN32
+KNAPSACK_KERNEL_VARIANT(x86_64_v3, KNAPSACK_KERNEL_TARGET("avx2,fma,bmi,bmi2"))
+KNAPSACK_KERNEL_VARIANT(x86_64_v4, KNAPSACK_KERNEL_TARGET("avx512f,avx512bw,avx512vl,avx512dq"))
+#endif
+#else
+KNAPSACK_KERNEL_VARIANT(generic, )
+#endif
+
+#undef KNAPSACK_KERNEL_VARIANT
+
+// Best first
+inline const Kernels* variants(size_t& count) {
+#ifdef KNAPSACK_KERNEL_DISPATCH
+    static const Kernels table[] = {
+#ifndef _WIN32
+        {"x86-64-v4", x86_64_v4::rowUpdate<int>, x86_64_v4::pairUpdate, x86_64_v4::unboundedRow<int>,
+         x86_64_v4::maxPlusMerge<int>, x86_64_v4::mergeTopK},
+        {"x86-64-v3", x86_64_v3::rowUpdate<int>, x86_64_v3::pairUpdate, x86_64_v3::unboundedRow<int>,
+         x86_64_v3::maxPlusMerge<int>, x86_64_v3::mergeTopK},
+#endif
+        {"x86-64-v2", x86_64_v2::rowUpdate<int>, x86_64_v2::pairUpdate, x86_64_v2::unboundedRow<int>,
+         x86_64_v2::maxPlusMerge<int>, x86_64_v2::mergeTopK},
+        {"x86-64", x86_64::rowUpdate<int>, x86_64::pairUpdate, x86_64::unboundedRow<int>,
+         x86_64::maxPlusMerge<int>, x86_64::mergeTopK},
+    };
+#else
+    static const Kernels table[] = {
+        {"generic", generic::rowUpdate<int>, generic::pairUpdate, generic::unboundedRow<int>,
+         generic::maxPlusMerge<int>, generic::mergeTopK},
+    };
+#endif
+    count = sizeof(table) / sizeof(table[0]);
+    return table;
+}
+
+inline bool hostSupports(const char* name) {
+#ifdef KNAPSACK_KERNEL_DISPATCH
+    __builtin_cpu_init();
+    if (std::strcmp(name, "x86-64-v4") == 0) {
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+               __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512dq");
+    }
+    if (std::strcmp(name, "x86-64-v3") == 0) {
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+               __builtin_cpu_supports("bmi") && __builtin_cpu_supports("bmi2");
+    }
+    if (std::strcmp(name, "x86-64-v2") == 0) {
+        return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+    }
+#endif
+    (void)name;
+    return true;  // Baseline
+}
+
+// The best variant the host supports, at or below KNAPSACK_ISA when that names one. Chosen once
+inline const Kernels& active() {
+    static const Kernels* chosen = [] {
+        size_t count;
+        const Kernels* table = variants(count);
+        size_t from = 0;
+        if (const char* cap = std::getenv("KNAPSACK_ISA")) {
+            for (size_t i = 0; i < count; i++) {
+                if (std::strcmp(table[i].name, cap) == 0) from = i;
+            }
+        }
+        for (size_t i = from; i < count; i++) {
+            if (hostSupports(table[i].name)) return &table[i];
+        }
+        return &table[count - 1];
+    }();
+    return *chosen;
+}
+
+// The row kernels for cell type T, from the variant active() chose
+template <class T>
+inline const RowKernels<T>& rowKernels() {
+#ifdef KNAPSACK_KERNEL_DISPATCH
+    static const RowKernels<T> table[] = {
+#ifndef _WIN32
+        {"x86-64-v4", x86_64_v4::rowUpdate<T>, x86_64_v4::unboundedRow<T>, x86_64_v4::maxPlusMerge<T>},
+        {"x86-64-v3", x86_64_v3::rowUpdate<T>, x86_64_v3::unboundedRow<T>, x86_64_v3::maxPlusMerge<T>},
+#endif
+        {"x86-64-v2", x86_64_v2::rowUpdate<T>, x86_64_v2::unboundedRow<T>, x86_64_v2::maxPlusMerge<T>},
+        {"x86-64", x86_64::rowUpdate<T>, x86_64::unboundedRow<T>, x86_64::maxPlusMerge<T>},
+    };
+#else
+    static const RowKernels<T> table[] = {
+        {"generic", generic::rowUpdate<T>, generic::unboundedRow<T>, generic::maxPlusMerge<T>},
+    };
+#endif
+    size_t count;
+    return table[&active() - variants(count)];  // Same order as variants()
+}
+
+}  // namespace knapsack_kernels
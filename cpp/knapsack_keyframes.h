@@ -0,0 +1,92 @@
+/**
+ * Trace Keyframes
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Periodic snapshots of the table a viewer has drawn after a given step, emitted next to the
+ *              step stream so the visualizer can seek without replaying every step before it.
+ *              Keyframe k is taken after step (k + 1) * interval - 1 and holds the full current contents of
+ *              every row changed since keyframe k - 1 (null for cells not filled yet), so the frames together
+ *              stay about the size of one table. Keyframe k for a step t is floor((t + 1) / interval) - 1.
+ *              The viewer turns the frames into the whole table at each keyframe once (keyframe k - 1's rows
+ *              with keyframe k's rows replacing them, which only copies row references); a seek is then one
+ *              restore of that table plus at most interval - 1 steps of replay
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "knapsack_cells.h"
+
+namespace knapsack_trace {
+
+// T: cell type of the table (knapsack_cells.h)
+template <class T = int>
+class KeyframeRecorder {
+private:
+    int cols;
+    long long interval;
+    long long steps = 0;
+    long long frameCount = 0;
+    std::vector<std::vector<T>> shown;       // Value the viewer displays per cell
+    std::vector<std::vector<char>> filled;   // Whether the cell has been drawn
+    std::vector<int> touched;                // Rows changed since the last keyframe
+    std::vector<char> isTouched;
+    std::stringstream frames;
+
+    void capture() {
+        std::sort(touched.begin(), touched.end());
+        if (frameCount > 0) frames << ",";
+        frames << "{\"step\":" << steps - 1 << ",\"rows\":[";
+        for (size_t k = 0; k < touched.size(); k++) frames << (k ? "," : "") << touched[k];
+        frames << "],\"values\":[";
+        for (size_t k = 0; k < touched.size(); k++) {
+            int r = touched[k];
+            frames << (k ? ",[" : "[");
+            for (int c = 0; c < cols; c++) {
+                if (c) frames << ",";
+                if (filled[r][c]) knapsack_cells::write(frames, shown[r][c]);
+                else frames << "null";
+            }
+            frames << "]";
+            isTouched[r] = 0;
+        }
+        frames << "]}";
+        touched.clear();
+        frameCount++;
+    }
+
+public:
+    // One keyframe per max(256, cols) steps keeps snapshots to a few percent of the step stream
+    KeyframeRecorder(int rows, int cols)
+        : cols(cols),
+          interval(std::max(256, cols)),
+          shown(rows, std::vector<T>(cols, T())),
+          filled(rows, std::vector<char>(cols, 0)),
+          isTouched(rows, 0) {}
+
+    // Record a step exactly as the viewer applies it
+    void step(int row, int col, T val) {
+        if (row >= 0 && row < (int)shown.size() && col >= 0 && col < cols) {
+            shown[row][col] = val;
+            filled[row][col] = 1;
+            if (!isTouched[row]) {
+                isTouched[row] = 1;
+                touched.push_back(row);
+            }
+        }
+        if (++steps % interval == 0) capture();
+    }
+
+    std::string json() const {
+        std::stringstream ss;
+        ss << "{\"interval\":" << interval << ",\"count\":" << frameCount << ",\"frames\":[" << frames.str() << "]}";
+        return ss.str();
+    }
+};
+
+}  // namespace knapsack_trace
@@ -11,9 +11,18 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <climits>
 #include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_cells.h"
+#include "knapsack_keyframes.h"
+#include "knapsack_kernels.h"
 
 using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_kth {
 
 struct Item {
     int weight;
@@ -35,8 +44,10 @@ public:
         firstItem = false;
     }
     void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
     void value(const string& v) { ss << "\"" << v << "\""; }
     void value(double v) { ss << v; }
+    void raw(const string& v) { ss << v; }
     void nextItem() {
         if (!firstItem) ss << ",";
         firstItem = false;
@@ -44,29 +55,12 @@ public:
     string str() { return ss.str(); }
 };
 
-// Merge two sorted arrays, keep top K
-vector<int> mergeTopK(const vector<int>& a, const vector<int>& b, int k) {
-    vector<int> result;
-    size_t i = 0, j = 0;
-    while ((int)result.size() < k && (i < a.size() || j < b.size())) {
-        if (i >= a.size()) {
-            result.push_back(b[j++]);
-        } else if (j >= b.size()) {
-            result.push_back(a[i++]);
-        } else if (a[i] >= b[j]) {
-            result.push_back(a[i++]);
-        } else {
-            result.push_back(b[j++]);
-        }
-    }
-    return result;
-}
-
-int main(int argc, char* argv[]) {
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
     auto startTime = chrono::high_resolution_clock::now();
     
     if (argc < 4) {
-        cout << R"({"code":400,"error":"Insufficient parameters"})";
+        out << R"({"code":400,"error":"Insufficient parameters"})";
         return 1;
     }
     
@@ -82,10 +76,20 @@ int main(int argc, char* argv[]) {
         items[i].value = stoi(arg.substr(comma + 1));
     }
     
+    // Any of the K best totals is a subset sum, within the sum of |v|; the int lists must hold it
+    knapsack_cells::int128 bound = 0;
+    for (const Item& item : items) bound += knapsack_cells::magnitude(item.value);
+    if (bound > INT_MAX) {
+        out << R"({"code":400,"error":"Total value exceeds the int range of the DP"})";
+        return 1;
+    }
+    
     // DP[i][j] = top K values for first i items with capacity j
+    profiler.enter(PREPROCESS);
     vector<vector<vector<int>>> dp(n + 1, 
         vector<vector<int>>(capacity + 1, vector<int>(1, 0)));
     
+    profiler.enter(SERIALIZE);
     JsonBuilder json;
     json.startObject();
     json.key("code"); json.value(200);
@@ -104,32 +108,45 @@ int main(int argc, char* argv[]) {
     }
     json.endArray();
     
+    OpCounters ops;  // Work done by the DP kernel
+    const knapsack_kernels::Kernels& kernels = knapsack_kernels::active();  // Widest ISA of this host
+    profiler.setKernel(kernels.name);
+    
+    knapsack_trace::KeyframeRecorder keyframes(n + 1, capacity + 1);
+    
     json.key("steps");
     json.startArray();
     
+    // Merge each row's top-K lists, then emit the row's steps
     for (int i = 1; i <= n; i++) {
         int w = items[i - 1].weight;
         int v = items[i - 1].value;
         
+        profiler.enter(DP);
+        static const vector<int> none;
+        for (int j = 0; j <= capacity; j++) {
+            // Skip: dp[i-1][j]; take this item: dp[i-1][j-w] with v added to each value
+            const vector<int>& skip = dp[i - 1][j];
+            const vector<int>& take = j >= w ? dp[i - 1][j - w] : none;
+            
+            // Merge and keep top K; values past the K-th are dropped
+            vector<int>& cell = dp[i][j];
+            cell.resize(min((size_t)K, skip.size() + take.size()));
+            cell.resize(kernels.mergeTopK(skip.data(), skip.size(), take.data(), take.size(), v, cell.data(), K));
+            long long offered = skip.size() + take.size();
+            ops.candidates += offered;
+            ops.pruned += offered - (long long)dp[i][j].size();
+        }
+        ops.cells += capacity + 1;
+        ops.merges += capacity + 1;
+        
+        profiler.enter(SERIALIZE);
         for (int j = 0; j <= capacity; j++) {
             json.nextItem();
             json.startObject();
             json.key("row"); json.value(i);
             json.key("col"); json.value(j);
             
-            vector<int> notTake = dp[i - 1][j];
-            vector<int> take;
-            
-            if (j >= w) {
-                // Take this item: add v to each value in dp[i-1][j-w]
-                for (int val : dp[i - 1][j - w]) {
-                    take.push_back(val + v);
-                }
-            }
-            
-            // Merge and keep top K
-            dp[i][j] = mergeTopK(notTake, take, K);
-            
             // Output top K values for current cell
             json.key("vals");
             json.startArray();
@@ -140,6 +157,7 @@ int main(int argc, char* argv[]) {
             json.endArray();
             
             json.key("val"); json.value(dp[i][j].empty() ? 0 : dp[i][j][0]);
+            keyframes.step(i, j, dp[i][j].empty() ? 0 : dp[i][j][0]);
             
             json.key("highlight");
             json.startArray();
@@ -164,6 +182,7 @@ int main(int argc, char* argv[]) {
         }
     }
     json.endArray();
+    json.key("keyframes"); json.raw(keyframes.json());
     
     json.key("path");
     json.startArray();
@@ -179,7 +198,7 @@ int main(int argc, char* argv[]) {
     json.endArray();
     
     json.key("max_value"); json.value(dp[n][capacity].empty() ? 0 : dp[n][capacity][0]);
-    json.key("kth_value"); json.value(dp[n][capacity].size() >= K ? dp[n][capacity][K-1] : 0);
+    json.key("kth_value"); json.value((int)dp[n][capacity].size() >= K ? dp[n][capacity][K-1] : 0);
     
     auto endTime = chrono::high_resolution_clock::now();
     double duration = chrono::duration<double, milli>(endTime - startTime).count();
@@ -189,15 +208,27 @@ int main(int argc, char* argv[]) {
     json.startObject();
     json.key("time"); json.value("O(n*C*K)");
     json.key("space"); json.value("O(n*C*K)");
-    json.key("operations"); json.value(n * (capacity + 1) * K);
-    json.key("memory_bytes"); json.value((n + 1) * (capacity + 1) * K * 4);
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((long long)(n + 1) * (capacity + 1) * K * 4);
     json.endObject();
     
-    json.endObject();
-    cout << json.str();
+    // The root object stays open: the profile is appended after the body has been written
+    writeResult(json.str(), profiler, out);
     return 0;
 }
 
+}  // namespace knapsack_kth
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_kth", knapsack_kth::run, argc, argv, cout);
+}
+#endif
+
 
 
 
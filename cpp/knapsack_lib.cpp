@@ -0,0 +1,121 @@
+/**
+ * Solver Library
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Implementation of the C ABI in knapsack_api.h. Compiled into knapsack.dll / libknapsack.so,
+ *              or straight into the Node addon (cpp/addon). Solves run on the caller's thread; several may
+ *              run at once since each solver keeps its state on the stack. The host's allocator is left
+ *              alone, so the allocation figures in the profile stay zero
+ */
+
+// Solvers are compiled without their main(), and must not replace the host's operator new
+#define KNAPSACK_LIBRARY
+#define KNAPSACK_NO_ALLOC_TRACKING
+
+#include <atomic>
+#include <exception>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "knapsack_api.h"
+#include "knapsack_profile.h"
+#include "knapsack_registry.h"
+
+struct knapsack_result {
+    std::string data;
+};
+
+struct knapsack_cancel_token {
+    std::atomic<int> flag{0};
+};
+
+namespace knapsack_lib {
+
+// Installs a cancel flag for the current thread for the lifetime of one solve
+class CancelScope {
+public:
+    explicit CancelScope(const std::atomic<int>* flag) { knapsack_profile::cancelFlag() = flag; }
+    ~CancelScope() { knapsack_profile::cancelFlag() = nullptr; }
+};
+
+// Messages end up inside a JSON string
+std::string escape(const std::string& s) {
+    std::string r;
+    for (char c : s) {
+        if (c == '"' || c == '\\') r += '\\';
+        if ((unsigned char)c >= 0x20) r += c;
+    }
+    return r;
+}
+
+}  // namespace knapsack_lib
+
+extern "C" {
+
+KNAPSACK_API int knapsack_abi_version(void) { return KNAPSACK_ABI_VERSION; }
+
+KNAPSACK_API knapsack_cancel_token* knapsack_cancel_token_create(void) {
+    return new (std::nothrow) knapsack_cancel_token();
+}
+
+KNAPSACK_API void knapsack_cancel(knapsack_cancel_token* token) {
+    if (token) token->flag.store(1, std::memory_order_relaxed);
+}
+
+KNAPSACK_API void knapsack_cancel_token_free(knapsack_cancel_token* token) { delete token; }
+
+KNAPSACK_API int knapsack_solve(const char* algorithm, int argc, const char* const* argv,
+                                knapsack_cancel_token* cancel, knapsack_result** result) {
+    if (result) *result = nullptr;
+    if (!algorithm || !result || argc < 1 || !argv) return KNAPSACK_FAILED;
+
+    auto it = knapsack_registry::SOLVERS.find(algorithm);
+    if (it == knapsack_registry::SOLVERS.end()) return KNAPSACK_UNKNOWN_ALGORITHM;
+
+    try {
+        // The solvers take a mutable argv like main() does, but never write to it
+        std::vector<std::string> args(argv, argv + argc);
+        std::vector<char*> ptrs;
+        for (std::string& a : args) ptrs.push_back(&a[0]);
+        ptrs.push_back(nullptr);
+
+        std::stringstream out;
+        int code;
+        {
+            knapsack_lib::CancelScope scope(cancel ? &cancel->flag : nullptr);
+            try {
+                code = it->second(argc, ptrs.data(), out);
+            } catch (const knapsack_profile::Cancelled&) {
+                return KNAPSACK_CANCELLED;
+            } catch (const std::bad_alloc&) {
+                return KNAPSACK_FAILED;
+            } catch (const std::exception& e) {
+                // Malformed numbers and the like, reported as the batch runner does
+                out.str("");
+                out << "{\"code\":400,\"error\":\"Invalid instance: " << knapsack_lib::escape(e.what()) << "\"}";
+                code = 1;
+            }
+        }
+
+        *result = new knapsack_result{out.str()};
+        return code == 0 ? KNAPSACK_OK : KNAPSACK_INVALID;
+    } catch (...) {
+        return KNAPSACK_FAILED;
+    }
+}
+
+KNAPSACK_API const char* knapsack_result_data(const knapsack_result* result, size_t* length) {
+    if (!result) {
+        if (length) *length = 0;
+        return nullptr;
+    }
+    if (length) *length = result->data.size();
+    return result->data.data();
+}
+
+KNAPSACK_API void knapsack_result_free(knapsack_result* result) { delete result; }
+
+}  // extern "C"
@@ -0,0 +1,293 @@
+/**
+ * 0/1 Knapsack Problem Algorithm (Meet-in-the-Middle)
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Meet-in-the-middle solution for 0/1 knapsack with few items (n <= 50) and huge capacities/weights,
+ *              where the capacity-indexed DP table cannot be allocated
+ *
+ * Input: Command line arguments, same format as knapsack_01
+ * Output: Standard output in JSON format (no animation steps, the path lists the chosen items)
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <climits>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <cstdint>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_cells.h"
+
+using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_mitm {
+
+const int MAX_ITEMS = 50;
+
+struct Item {
+    long long weight;
+    long long value;
+};
+
+// One subset of a half: total weight, total value and the item mask inside that half
+struct Subset {
+    long long weight;
+    long long value;
+    uint32_t mask;
+};
+
+class JsonBuilder {
+private:
+    stringstream ss;
+    bool firstItem = true;
+
+public:
+    void startObject() { ss << "{"; firstItem = true; }
+    void endObject() { ss << "}"; firstItem = false; }
+    void startArray() { ss << "["; firstItem = true; }
+    void endArray() { ss << "]"; firstItem = false; }
+
+    void key(const string& k) {
+        if (!firstItem) ss << ",";
+        ss << "\"" << k << "\":";
+        firstItem = false;
+    }
+
+    void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
+    void value(const string& v) { ss << "\"" << v << "\""; }
+    void value(double v) { ss << v; }
+
+    void nextItem() {
+        if (!firstItem) ss << ",";
+        firstItem = false;
+    }
+
+    string str() { return ss.str(); }
+};
+
+// Enumerate subset sums of items[first, first + count) in Gray-code order.
+// Slot i holds the subset gray(i) = i ^ (i >> 1); consecutive slots differ by exactly one item,
+// so each subset costs O(1) instead of O(count). The index range is split into contiguous chunks,
+// each chunk seeds its starting subset directly and then walks the Gray sequence on its own thread.
+// Every chunk counts its work in its own OpCounters slot, summed into ops after the join.
+vector<Subset> enumerateHalf(const vector<Item>& items, int first, int count, int threads, OpCounters& ops) {
+    size_t total = (size_t)1 << count;
+    vector<Subset> subsets(total);
+
+    auto walk = [&](size_t begin, size_t end, OpCounters& local) {
+        uint32_t mask = (uint32_t)(begin ^ (begin >> 1));
+        long long w = 0, v = 0;
+        for (int b = 0; b < count; b++) {
+            if (mask & (1u << b)) {
+                w += items[first + b].weight;
+                v += items[first + b].value;
+            }
+        }
+        subsets[begin] = {w, v, mask};
+        for (size_t i = begin + 1; i < end; i++) {
+            int b = __builtin_ctzll(i);  // Bit flipped between gray(i-1) and gray(i)
+            mask ^= (1u << b);
+            if (mask & (1u << b)) {
+                w += items[first + b].weight;
+                v += items[first + b].value;
+            } else {
+                w -= items[first + b].weight;
+                v -= items[first + b].value;
+            }
+            subsets[i] = {w, v, mask};
+        }
+        local.cells += end - begin;
+        local.candidates += count + (end - begin - 1);  // Seed sums plus one Gray step per subset
+    };
+
+    // Small halves are not worth a thread launch
+    if (threads <= 1 || count < 12) {
+        walk(0, total, ops);
+        return subsets;
+    }
+
+    size_t chunk = (total + threads - 1) / threads;
+    vector<OpCounters> perThread(threads);
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) {
+        size_t begin = t * chunk;
+        size_t end = min(total, begin + chunk);
+        if (begin >= end) break;
+        pool.emplace_back(walk, begin, end, ref(perThread[t]));
+    }
+    for (auto& th : pool) th.join();
+    for (const OpCounters& local : perThread) ops += local;
+    return subsets;
+}
+
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
+    auto startTime = chrono::high_resolution_clock::now();
+
+    // Format: knapsack_mitm.exe <capacity> <n> <w1,v1> <w2,v2> ...
+    if (argc < 3) {
+        out << R"({"code":400,"error":"Insufficient parameters"})";
+        return 1;
+    }
+
+    long long capacity = stoll(argv[1]);
+    int n = stoi(argv[2]);
+
+    if (n > MAX_ITEMS) {
+        out << R"({"code":400,"error":"Meet-in-the-middle supports at most 50 items"})";
+        return 1;
+    }
+
+    vector<Item> items(n);
+    for (int i = 0; i < n && i + 3 < argc; i++) {
+        string arg = argv[i + 3];
+        size_t comma = arg.find(',');
+        items[i].weight = stoll(arg.substr(0, comma));
+        items[i].value = stoll(arg.substr(comma + 1));
+    }
+
+    // Subset sums are long long: every half's sum stays within the sum of |v|
+    knapsack_cells::int128 bound = 0;
+    for (const Item& item : items) bound += knapsack_cells::magnitude(item.value);
+    if (bound > LLONG_MAX) {
+        out << R"({"code":400,"error":"Total value exceeds the 64-bit range of the DP"})";
+        return 1;
+    }
+
+    int threads = max(1u, thread::hardware_concurrency());
+
+    // Split into halves A = [0, n1) and B = [n1, n)
+    int n1 = n / 2;
+    int n2 = n - n1;
+    profiler.enter(DP);
+    OpCounters ops;
+    vector<Subset> halfA = enumerateHalf(items, 0, n1, threads, ops);
+    vector<Subset> halfB = enumerateHalf(items, n1, n2, threads, ops);
+    size_t enumerated = halfA.size() + halfB.size();
+
+    // Prune B into a monotone frontier: weight ascending, value strictly ascending.
+    // A subset that is heavier but not more valuable than a lighter one can never be the best partner.
+    sort(halfB.begin(), halfB.end(), [](const Subset& a, const Subset& b) {
+        return a.weight != b.weight ? a.weight < b.weight : a.value > b.value;
+    });
+    vector<Subset> frontier;
+    for (const Subset& s : halfB) {
+        if (s.weight > capacity) break;
+        if (frontier.empty() || s.value > frontier.back().value) {
+            frontier.push_back(s);
+        }
+    }
+    ops.pruned += halfB.size() - frontier.size();  // Dominated or too heavy
+
+    // Two-pointer sweep: as A gets heavier the remaining capacity shrinks,
+    // so the best fitting frontier entry only moves left
+    sort(halfA.begin(), halfA.end(), [](const Subset& a, const Subset& b) {
+        return a.weight < b.weight;
+    });
+    long long maxValue = 0;
+    uint32_t bestMaskA = 0, bestMaskB = 0;
+    long long p = (long long)frontier.size() - 1;
+    for (const Subset& a : halfA) {
+        if (a.weight > capacity) break;
+        long long remain = capacity - a.weight;
+        while (p >= 0 && frontier[p].weight > remain) p--;
+        if (p < 0) break;
+        ops.candidates++;
+        if (a.value + frontier[p].value > maxValue) {
+            maxValue = a.value + frontier[p].value;
+            bestMaskA = a.mask;
+            bestMaskB = frontier[p].mask;
+        }
+    }
+    ops.merges++;  // One sweep joins the two halves
+
+    profiler.enter(RECONSTRUCT);
+    vector<bool> chosen(n, false);
+    for (int b = 0; b < n1; b++) {
+        if (bestMaskA & (1u << b)) chosen[b] = true;
+    }
+    for (int b = 0; b < n2; b++) {
+        if (bestMaskB & (1u << b)) chosen[n1 + b] = true;
+    }
+
+    profiler.enter(SERIALIZE);
+    JsonBuilder json;
+    json.startObject();
+
+    json.key("code"); json.value(200);
+    json.key("type"); json.value("0/1 Knapsack (Meet-in-the-Middle)");
+    json.key("capacity"); json.value(capacity);
+
+    json.key("items");
+    json.startArray();
+    for (int i = 0; i < n; i++) {
+        json.nextItem();
+        json.startObject();
+        json.key("w"); json.value(items[i].weight);
+        json.key("v"); json.value(items[i].value);
+        json.endObject();
+    }
+    json.endArray();
+
+    // No DP table to animate
+    json.key("steps");
+    json.startArray();
+    json.endArray();
+
+    // Path in the same shape as knapsack_01's backtrack: last item first, c = capacity left before taking it
+    json.key("path");
+    json.startArray();
+    long long j = capacity;
+    for (int i = n; i > 0; i--) {
+        if (chosen[i - 1]) {
+            json.nextItem();
+            json.startObject();
+            json.key("r"); json.value(i);
+            json.key("c"); json.value(j);
+            json.key("item"); json.value(i - 1);
+            json.endObject();
+            j -= items[i - 1].weight;
+        }
+    }
+    json.endArray();
+
+    json.key("max_value"); json.value(maxValue);
+
+    auto endTime = chrono::high_resolution_clock::now();
+    double duration = chrono::duration<double, milli>(endTime - startTime).count();
+    json.key("time_ms"); json.value(duration);
+
+    json.key("complexity");
+    json.startObject();
+    json.key("time"); json.value("O(2^(n/2)*n)");
+    json.key("space"); json.value("O(2^(n/2))");
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((long long)(enumerated * sizeof(Subset)));
+    json.key("frontier"); json.value((long long)frontier.size());
+    json.key("threads"); json.value(threads);
+    json.endObject();
+
+    writeResult(json.str(), profiler, out);
+
+    return 0;
+}
+
+}  // namespace knapsack_mitm
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_mitm", knapsack_mitm::run, argc, argv, cout);
+}
+#endif
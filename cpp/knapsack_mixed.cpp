@@ -11,9 +11,17 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <climits>
 #include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_cells.h"
+#include "knapsack_keyframes.h"
 
 using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_mixed {
 
 struct Item {
     int weight;
@@ -28,17 +36,19 @@ private:
     bool firstItem = true;
 public:
     void startObject() { ss << "{"; firstItem = true; }
-    void endObject() { ss << "}"; }
+    void endObject() { ss << "}"; firstItem = false; }
     void startArray() { ss << "["; firstItem = true; }
-    void endArray() { ss << "]"; }
+    void endArray() { ss << "]"; firstItem = false; }
     void key(const string& k) {
         if (!firstItem) ss << ",";
         ss << "\"" << k << "\":";
         firstItem = false;
     }
     void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
     void value(const string& v) { ss << "\"" << v << "\""; }
     void value(double v) { ss << v; }
+    void raw(const string& v) { ss << v; }
     void nextItem() {
         if (!firstItem) ss << ",";
         firstItem = false;
@@ -46,11 +56,12 @@ public:
     string str() { return ss.str(); }
 };
 
-int main(int argc, char* argv[]) {
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
     auto startTime = chrono::high_resolution_clock::now();
     
     if (argc < 3) {
-        cout << R"({"code":400,"error":"Insufficient parameters"})";
+        out << R"({"code":400,"error":"Insufficient parameters"})";
         return 1;
     }
     
@@ -68,8 +79,27 @@ int main(int argc, char* argv[]) {
         items[i].count = (items[i].type == 2) ? 3 : 1;  // Multiple knapsack default 3
     }
     
+    // Bounded items add at most their copies' values, complete items fill at most the whole capacity at the
+    // best value/weight ratio among them; the int cells must hold the sum of the two
+    knapsack_cells::int128 bound = 0, unboundedBound = 0;
+    for (const Item& item : items) {
+        knapsack_cells::int128 v = knapsack_cells::magnitude(item.value);
+        if (item.type != 1) bound += v * item.count;
+        else if (item.weight > 0) unboundedBound = max(unboundedBound, max(v, v * capacity / item.weight));
+        else unboundedBound = max(unboundedBound, v);
+    }
+    if (bound + unboundedBound > INT_MAX) {
+        out << R"({"code":400,"error":"Total value exceeds the int range of the DP"})";
+        return 1;
+    }
+    
+    profiler.enter(PREPROCESS);
     vector<vector<int>> dp(n + 1, vector<int>(capacity + 1, 0));
     
+    // Source column of the winning transition per cell of the current row (-1 = not taken)
+    vector<int> fromCol(capacity + 1, -1);
+    
+    profiler.enter(SERIALIZE);
     JsonBuilder json;
     json.startObject();
     json.key("code"); json.value(200);
@@ -88,6 +118,10 @@ int main(int argc, char* argv[]) {
     }
     json.endArray();
     
+    OpCounters ops;  // Work done by the DP kernel
+    
+    knapsack_trace::KeyframeRecorder keyframes(n + 1, capacity + 1);
+    
     json.key("steps");
     json.startArray();
     
@@ -96,57 +130,63 @@ int main(int argc, char* argv[]) {
         int v = items[i - 1].value;
         int type = items[i - 1].type;
         
+        profiler.enter(DP);
         // First copy previous row
         for (int j = 0; j <= capacity; j++) {
             dp[i][j] = dp[i - 1][j];
         }
+        long long takes = 0;  // Take options compared in this row
         
         for (int j = 0; j <= capacity; j++) {
-            json.nextItem();
-            json.startObject();
-            json.key("row"); json.value(i);
-            json.key("col"); json.value(j);
-            json.key("itemType"); json.value(type);
-            
-            string typeStr = (type == 0) ? "0/1" : (type == 1) ? "Complete" : "Multiple";
-            json.key("typeStr"); json.value(typeStr);
-            
-            int oldVal = dp[i - 1][j];
-            int newVal = oldVal;
-            int fromRow = i - 1, fromCol = j;
-            bool took = false;
+            int newVal = dp[i - 1][j];
+            fromCol[j] = -1;
             
             if (type == 0) {
                 // 0/1 knapsack
+                takes += j >= w;
                 if (j >= w && dp[i - 1][j - w] + v > newVal) {
                     newVal = dp[i - 1][j - w] + v;
-                    fromRow = i - 1;
-                    fromCol = j - w;
-                    took = true;
+                    fromCol[j] = j - w;
                 }
             } else if (type == 1) {
                 // Complete knapsack
+                takes += j >= w;
                 if (j >= w && dp[i][j - w] + v > newVal) {
                     newVal = dp[i][j - w] + v;
-                    fromRow = i;
-                    fromCol = j - w;
-                    took = true;
+                    fromCol[j] = j - w;
                 }
             } else {
                 // Multiple knapsack (simplified, max 3)
                 for (int k = 1; k <= items[i-1].count && k * w <= j; k++) {
+                    takes++;
                     if (dp[i - 1][j - k * w] + k * v > newVal) {
                         newVal = dp[i - 1][j - k * w] + k * v;
-                        fromRow = i - 1;
-                        fromCol = j - k * w;
-                        took = true;
+                        fromCol[j] = j - k * w;
                     }
                 }
             }
             
             dp[i][j] = newVal;
+        }
+        
+        ops.cells += capacity + 1;
+        ops.candidates += capacity + 1 + takes;
+        
+        profiler.enter(SERIALIZE);
+        string typeStr = (type == 0) ? "0/1" : (type == 1) ? "Complete" : "Multiple";
+        int fromRow = (type == 1) ? i : i - 1;
+        for (int j = 0; j <= capacity; j++) {
+            bool took = fromCol[j] >= 0;
+            
+            json.nextItem();
+            json.startObject();
+            json.key("row"); json.value(i);
+            json.key("col"); json.value(j);
+            json.key("itemType"); json.value(type);
+            json.key("typeStr"); json.value(typeStr);
             
             json.key("val"); json.value(dp[i][j]);
+            keyframes.step(i, j, dp[i][j]);
             json.key("highlight");
             json.startArray();
             json.nextItem();
@@ -159,7 +199,7 @@ int main(int argc, char* argv[]) {
                 json.nextItem();
                 json.startObject();
                 json.key("r"); json.value(fromRow);
-                json.key("c"); json.value(fromCol);
+                json.key("c"); json.value(fromCol[j]);
                 json.key("type"); json.value("with");
                 json.endObject();
             }
@@ -170,18 +210,15 @@ int main(int argc, char* argv[]) {
         }
     }
     json.endArray();
+    json.key("keyframes"); json.raw(keyframes.json());
     
-    json.key("path");
-    json.startArray();
+    // Backtrack
+    profiler.enter(RECONSTRUCT);
+    vector<pair<int, int>> path;  // (row, col) of each selected item
     int j = capacity;
     for (int i = n; i > 0 && j > 0; i--) {
         if (dp[i][j] != dp[i - 1][j]) {
-            json.nextItem();
-            json.startObject();
-            json.key("r"); json.value(i);
-            json.key("c"); json.value(j);
-            json.key("item"); json.value(i - 1);
-            json.endObject();
+            path.push_back({i, j});
             
             int w = items[i - 1].weight;
             int type = items[i - 1].type;
@@ -195,6 +232,18 @@ int main(int argc, char* argv[]) {
             }
         }
     }
+    
+    profiler.enter(SERIALIZE);
+    json.key("path");
+    json.startArray();
+    for (auto& [r, c] : path) {
+        json.nextItem();
+        json.startObject();
+        json.key("r"); json.value(r);
+        json.key("c"); json.value(c);
+        json.key("item"); json.value(r - 1);
+        json.endObject();
+    }
     json.endArray();
     
     json.key("max_value"); json.value(dp[n][capacity]);
@@ -207,15 +256,27 @@ int main(int argc, char* argv[]) {
     json.startObject();
     json.key("time"); json.value("O(n*C)");
     json.key("space"); json.value("O(n*C)");
-    json.key("operations"); json.value(n * (capacity + 1));
-    json.key("memory_bytes"); json.value((n + 1) * (capacity + 1) * 4);
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((long long)(n + 1) * (capacity + 1) * 4);
     json.endObject();
     
-    json.endObject();
-    cout << json.str();
+    // The root object stays open: the profile is appended after the body has been written
+    writeResult(json.str(), profiler, out);
     return 0;
 }
 
+}  // namespace knapsack_mixed
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_mixed", knapsack_mixed::run, argc, argv, cout);
+}
+#endif
+
 
 
 
@@ -11,9 +11,19 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <climits>
 #include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_cells.h"
+#include "knapsack_trace_codec.h"
+#include "row_store.h"
+#include "knapsack_kernels.h"
 
 using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_multiple {
 
 struct Item {
     int weight;
@@ -34,17 +44,19 @@ private:
     bool firstItem = true;
 public:
     void startObject() { ss << "{"; firstItem = true; }
-    void endObject() { ss << "}"; }
+    void endObject() { ss << "}"; firstItem = false; }
     void startArray() { ss << "["; firstItem = true; }
-    void endArray() { ss << "]"; }
+    void endArray() { ss << "]"; firstItem = false; }
     void key(const string& k) {
         if (!firstItem) ss << ",";
         ss << "\"" << k << "\":";
         firstItem = false;
     }
     void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
     void value(const string& v) { ss << "\"" << v << "\""; }
     void value(double v) { ss << v; }
+    void raw(const string& v) { ss << v; }
     void nextItem() {
         if (!firstItem) ss << ",";
         firstItem = false;
@@ -52,11 +64,12 @@ public:
     string str() { return ss.str(); }
 };
 
-int main(int argc, char* argv[]) {
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
     auto startTime = chrono::high_resolution_clock::now();
     
     if (argc < 3) {
-        cout << R"({"code":400,"error":"Insufficient parameters"})";
+        out << R"({"code":400,"error":"Insufficient parameters"})";
         return 1;
     }
     
@@ -73,7 +86,16 @@ int main(int argc, char* argv[]) {
         items[i].count = stoi(arg.substr(comma2 + 1));
     }
     
+    // Every piece value and every cell stays within the sum of |v| * count, which the int cells must hold
+    knapsack_cells::int128 bound = 0;
+    for (const Item& item : items) bound += knapsack_cells::magnitude(item.value) * max(0, item.count);
+    if (bound > INT_MAX) {
+        out << R"({"code":400,"error":"Total value exceeds the int range of the DP"})";
+        return 1;
+    }
+    
     // Binary decomposition
+    profiler.enter(PREPROCESS);
     vector<SplitItem> splitItems;
     for (int i = 0; i < n; i++) {
         int cnt = items[i].count;
@@ -97,8 +119,10 @@ int main(int argc, char* argv[]) {
     }
     
     int m = splitItems.size();
-    vector<vector<int>> dp(m + 1, vector<int>(capacity + 1, 0));
+    knapsack_rows::RowStore<int> dp(m + 1, capacity + 1, "knapsack_multiple");  // In memory or mapped
+    const bool omitted = knapsack_trace::stepsOmitted(argc, argv);  // --trace=none
     
+    profiler.enter(SERIALIZE);
     JsonBuilder json;
     json.startObject();
     json.key("code"); json.value(200);
@@ -132,80 +156,86 @@ int main(int argc, char* argv[]) {
     }
     json.endArray();
     
-    json.key("steps");
-    json.startArray();
+    OpCounters ops;  // Work done by the DP kernel
+    const knapsack_kernels::Kernels& kernels = knapsack_kernels::active();  // Widest ISA of this host
+    profiler.setKernel(kernels.name);
     
-    // Convert to 0/1 knapsack for solving
+    if (!omitted) {
+        json.key("steps");
+        json.startArray();
+    }
+    
+    // Convert to 0/1 knapsack for solving; compute each row, then emit its steps
     for (int i = 1; i <= m; i++) {
         int w = splitItems[i - 1].weight;
         int v = splitItems[i - 1].value;
         
+        profiler.enter(DP);
+        kernels.rowUpdate(dp[i - 1], dp[i], capacity + 1, w, v);
+        
+        dp.rowDone(i);
+        
+        ops.cells += capacity + 1;
+        ops.candidates += capacity + 1 + max(0, capacity - w + 1);  // Skip everywhere, take where it fits
+        
+        if (omitted) continue;
+        profiler.enter(SERIALIZE);
         for (int j = 0; j <= capacity; j++) {
             json.nextItem();
             json.startObject();
             json.key("row"); json.value(i);
             json.key("col"); json.value(j);
             json.key("origItem"); json.value(splitItems[i - 1].originalIndex);
-            
-            if (j < w) {
-                dp[i][j] = dp[i - 1][j];
-                json.key("val"); json.value(dp[i][j]);
-                json.key("highlight");
-                json.startArray();
-                json.nextItem();
-                json.startObject();
-                json.key("r"); json.value(i - 1);
-                json.key("c"); json.value(j);
-                json.key("type"); json.value("without");
-                json.endObject();
-                json.endArray();
-                json.key("decision"); json.value("skip");
-            } else {
-                int withoutItem = dp[i - 1][j];
-                int withItem = dp[i - 1][j - w] + v;
-                dp[i][j] = max(withoutItem, withItem);
-                
-                json.key("val"); json.value(dp[i][j]);
-                json.key("highlight");
-                json.startArray();
-                json.nextItem();
-                json.startObject();
-                json.key("r"); json.value(i - 1);
-                json.key("c"); json.value(j);
-                json.key("type"); json.value("without");
-                json.endObject();
+            json.key("val"); json.value(dp[i][j]);
+            json.key("highlight");
+            json.startArray();
+            json.nextItem();
+            json.startObject();
+            json.key("r"); json.value(i - 1);
+            json.key("c"); json.value(j);
+            json.key("type"); json.value("without");
+            json.endObject();
+            if (j >= w) {
                 json.nextItem();
                 json.startObject();
                 json.key("r"); json.value(i - 1);
                 json.key("c"); json.value(j - w);
                 json.key("type"); json.value("with");
                 json.endObject();
-                json.endArray();
-                
-                json.key("decision"); 
-                json.value(dp[i][j] == withoutItem ? "skip" : "take");
             }
+            json.endArray();
+            
+            json.key("decision"); 
+            json.value(j < w || dp[i][j] == dp[i - 1][j] ? "skip" : "take");
             json.endObject();
         }
     }
-    json.endArray();
+    if (!omitted) json.endArray();
     
     // Backtrack
-    json.key("path");
-    json.startArray();
+    profiler.enter(RECONSTRUCT);
+    vector<pair<int, int>> path;  // (row, col) of each taken split item
     int j = capacity;
     for (int i = m; i > 0 && j > 0; i--) {
+        dp.reading(i - 1);
         if (dp[i][j] != dp[i - 1][j]) {
-            json.nextItem();
-            json.startObject();
-            json.key("r"); json.value(i);
-            json.key("c"); json.value(j);
-            json.key("item"); json.value(splitItems[i - 1].originalIndex);
-            json.key("splitCnt"); json.value(splitItems[i - 1].splitCount);
-            json.endObject();
+            path.push_back({i, j});
             j -= splitItems[i - 1].weight;
         }
     }
+    
+    profiler.enter(SERIALIZE);
+    json.key("path");
+    json.startArray();
+    for (auto& [r, c] : path) {
+        json.nextItem();
+        json.startObject();
+        json.key("r"); json.value(r);
+        json.key("c"); json.value(c);
+        json.key("item"); json.value(splitItems[r - 1].originalIndex);
+        json.key("splitCnt"); json.value(splitItems[r - 1].splitCount);
+        json.endObject();
+    }
     json.endArray();
     
     json.key("max_value"); json.value(dp[m][capacity]);
@@ -218,15 +248,30 @@ int main(int argc, char* argv[]) {
     json.startObject();
     json.key("time"); json.value("O(C*Σlog(k))");
     json.key("space"); json.value("O(m*C)");
-    json.key("operations"); json.value(m * (capacity + 1));
-    json.key("memory_bytes"); json.value((m + 1) * (capacity + 1) * 4);
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((long long)(m + 1) * (capacity + 1) * 4);
     json.endObject();
+    if (dp.mapped()) {
+        json.key("row_store"); json.raw(dp.json());
+    }
     
-    json.endObject();
-    cout << json.str();
+    // The root object stays open: the profile is appended after the body has been written
+    writeResult(json.str(), profiler, out);
     return 0;
 }
 
+}  // namespace knapsack_multiple
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_multiple", knapsack_multiple::run, argc, argv, cout);
+}
+#endif
+
 
 
 
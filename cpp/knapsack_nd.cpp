@@ -0,0 +1,545 @@
+/**
+ * Multi-Dimensional Cost Knapsack Algorithm
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description 0/1 knapsack under d resource limits (weight, volume, budget, slots, ...), in one of two
+ *              storages:
+ *                dense    one value per point of the capacity box, updated in place from the far corner down
+ *                         like the 1D 0/1 row, plus one decision bit per item and point
+ *                sparse   per item prefix, only the reachable resource vectors no other one dominates (uses
+ *                         no more of any resource and is worth at least as much). Equal vectors are merged
+ *                         through a hash map, then a sweep in decreasing value drops the dominated ones, looked
+ *                         up in a k-d tree of the vectors kept so far
+ *              The box is used while it fits DENSE_MAX_BYTES and holds fewer points than the 2^n subsets
+ *              that bound the sparse states, the sparse states otherwise; --storage=dense|sparse forces one.
+ *              Both report the states visited and the peak state count
+ *
+ * Input: Command line arguments, <c1> ... <cd> <n> followed by items <w1,...,wd,v>; d is the number of
+ *        limits before n, so knapsack_2d's arguments are the d = 2 case
+ * Output: Standard output in JSON format (no animation steps)
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <climits>
+#include <unordered_set>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_cells.h"
+
+using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_nd {
+
+// Largest dense box: values plus decision bits
+const long long DENSE_MAX_BYTES = 512LL * 1024 * 1024;
+
+// Most live sparse states after any item
+const size_t MAX_STATES = 1 << 22;
+
+struct Item {
+    vector<int> costs;
+    long long value;
+};
+
+class JsonBuilder {
+private:
+    stringstream ss;
+    bool firstItem = true;
+
+public:
+    void startObject() { ss << "{"; firstItem = true; }
+    void endObject() { ss << "}"; firstItem = false; }
+    void startArray() { ss << "["; firstItem = true; }
+    void endArray() { ss << "]"; firstItem = false; }
+
+    void key(const string& k) {
+        if (!firstItem) ss << ",";
+        ss << "\"" << k << "\":";
+        firstItem = false;
+    }
+
+    void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
+    void value(const string& v) { ss << "\"" << v << "\""; }
+    void value(double v) { ss << v; }
+
+    void nextItem() {
+        if (!firstItem) ss << ",";
+        firstItem = false;
+    }
+
+    string str() { return ss.str(); }
+};
+
+// What a storage found, and what it cost
+struct Outcome {
+    long long best = 0;
+    vector<char> taken;       // Per item
+    long long visited = 0;    // States generated (dense: points updated)
+    long long peak = 0;       // Most states held at once (dense: points in the box)
+    long long memoryBytes = 0;
+};
+
+// Dense box in row-major order, last limit contiguous
+Outcome solveDense(const vector<int>& caps, const vector<Item>& items, long long cells, OpCounters& ops) {
+    int d = caps.size();
+    int n = items.size();
+    vector<long long> stride(d, 1);
+    for (int k = d - 2; k >= 0; k--) stride[k] = stride[k + 1] * (caps[k + 1] + 1);
+
+    Outcome result;
+    vector<long long> dp(cells, 0);
+    size_t words = (size_t)(cells + 63) / 64;
+    vector<vector<uint64_t>> took(n, vector<uint64_t>(words, 0));
+    vector<long long> offset(n, 0);
+
+    vector<int> coord(d);
+    for (int i = 0; i < n; i++) {
+        const vector<int>& w = items[i].costs;
+        long long v = items[i].value;
+        bool fits = true;
+        for (int k = 0; k < d; k++) {
+            offset[i] += w[k] * stride[k];
+            fits = fits && w[k] <= caps[k];
+        }
+        ops.cells += cells;
+        if (!fits) continue;
+
+        // Points with every coordinate >= w, from the far corner down: dp[x - w] is still the previous prefix
+        for (int k = 0; k < d; k++) coord[k] = caps[k];
+        uint64_t* bits = took[i].data();
+        while (true) {
+            long long base = 0;
+            for (int k = 0; k + 1 < d; k++) base += coord[k] * stride[k];
+            for (long long idx = base + caps[d - 1]; idx >= base + w[d - 1]; idx--) {
+                long long cand = dp[idx - offset[i]] + v;
+                if (cand > dp[idx]) {
+                    dp[idx] = cand;
+                    bits[idx >> 6] |= 1ULL << (idx & 63);
+                }
+            }
+            ops.candidates += caps[d - 1] - w[d - 1] + 1;
+
+            int k = d - 2;
+            while (k >= 0 && coord[k] == w[k]) {
+                coord[k] = caps[k];
+                k--;
+            }
+            if (k < 0) break;
+            coord[k]--;
+        }
+    }
+    result.visited = (long long)n * cells;
+    result.peak = cells;
+    result.memoryBytes = cells * (long long)sizeof(long long) + (long long)n * words * 8;
+
+    result.taken.assign(n, 0);
+    long long idx = cells - 1;
+    result.best = dp[idx];
+    for (int i = n - 1; i >= 0; i--) {
+        if (took[i][idx >> 6] >> (idx & 63) & 1) {
+            result.taken[i] = 1;
+            idx -= offset[i];
+        }
+    }
+    return result;
+}
+
+// Sparse states: each is a node holding its resource vector, value and the node it was extended from
+class StateArena {
+private:
+    int d;
+    vector<int> uses;          // d per node
+    vector<long long> worth;
+    vector<int> parent;        // -1 for the empty selection
+    vector<int> item;          // Item taken to reach this node
+
+public:
+    explicit StateArena(int d) : d(d) {}
+
+    size_t size() const { return worth.size(); }
+    const int* use(int id) const { return uses.data() + (size_t)id * d; }
+    long long value(int id) const { return worth[id]; }
+    int parentOf(int id) const { return parent[id]; }
+    int itemOf(int id) const { return item[id]; }
+
+    // from + the item's cost and value; from = -1 for the empty selection
+    int add(int from, const vector<int>& cost, long long v, int it) {
+        size_t at = uses.size();
+        uses.resize(at + d);
+        for (int k = 0; k < d; k++) uses[at + k] = (from >= 0 ? uses[(size_t)from * d + k] : 0) + cost[k];
+        worth.push_back(from >= 0 ? worth[from] + v : v);
+        parent.push_back(from);
+        item.push_back(it);
+        return worth.size() - 1;
+    }
+
+    // Keep only the nodes reachable from live through parents (parents are always older, so ids stay
+    // ordered); live is renumbered in place
+    void compact(vector<int>& live) {
+        vector<int> remap(size(), -1);
+        for (int id : live) {
+            for (int p = id; p >= 0 && remap[p] < 0; p = parent[p]) remap[p] = 0;
+        }
+        int next = 0;
+        for (size_t id = 0; id < size(); id++) {
+            if (remap[id] < 0) continue;
+            remap[id] = next;
+            copy(uses.begin() + id * d, uses.begin() + (id + 1) * d, uses.begin() + (size_t)next * d);
+            worth[next] = worth[id];
+            parent[next] = parent[id] >= 0 ? remap[parent[id]] : -1;
+            item[next] = item[id];
+            next++;
+        }
+        uses.resize((size_t)next * d);
+        worth.resize(next);
+        parent.resize(next);
+        item.resize(next);
+        for (int& id : live) id = remap[id];
+    }
+
+    long long bytes() const {
+        return (long long)size() * (d * sizeof(int) + sizeof(long long) + 2 * sizeof(int));
+    }
+};
+
+// Resource vectors of the states kept so far as a k-d tree. Every node also holds the componentwise minimum
+// of its subtree, so a query skips whole subtrees that cannot contain a vector <= the one asked about
+class DominanceTree {
+private:
+    int d;
+    vector<int> coords;  // d per node
+    vector<int> lows;    // d per node: minimum over the subtree
+    vector<int> left, right;
+
+public:
+    explicit DominanceTree(int d) : d(d) {}
+
+    void clear() {
+        coords.clear();
+        lows.clear();
+        left.clear();
+        right.clear();
+    }
+
+    // Some stored vector uses no more of any resource than x
+    bool covers(const int* x, vector<int>& stack) const {
+        if (left.empty()) return false;
+        stack.assign(1, 0);
+        while (!stack.empty()) {
+            int node = stack.back();
+            stack.pop_back();
+            const int* low = lows.data() + (size_t)node * d;
+            bool possible = true;
+            for (int k = 0; k < d && possible; k++) possible = low[k] <= x[k];
+            if (!possible) continue;
+            const int* p = coords.data() + (size_t)node * d;
+            bool within = true;
+            for (int k = 0; k < d && within; k++) within = p[k] <= x[k];
+            if (within) return true;
+            if (left[node] >= 0) stack.push_back(left[node]);
+            if (right[node] >= 0) stack.push_back(right[node]);
+        }
+        return false;
+    }
+
+    void insert(const int* x) {
+        int id = left.size();
+        coords.insert(coords.end(), x, x + d);
+        lows.insert(lows.end(), x, x + d);
+        left.push_back(-1);
+        right.push_back(-1);
+        if (id == 0) return;
+        int node = 0;
+        for (int depth = 0;; depth++) {
+            int* low = lows.data() + (size_t)node * d;
+            for (int k = 0; k < d; k++) low[k] = min(low[k], x[k]);
+            int axis = depth % d;
+            vector<int>& next = x[axis] < coords[(size_t)node * d + axis] ? left : right;
+            if (next[node] < 0) {
+                next[node] = id;
+                return;
+            }
+            node = next[node];
+        }
+    }
+};
+
+Outcome solveSparse(const vector<int>& caps, const vector<Item>& items, OpCounters& ops, string& error) {
+    int d = caps.size();
+    int n = items.size();
+    Outcome result;
+    StateArena arena(d);
+    vector<int> live = {arena.add(-1, vector<int>(d, 0), 0, -1)};
+    size_t compactedSize = 1;
+    long long peakBytes = arena.bytes();
+    result.peak = 1;
+
+    auto hash = [&](int id) {
+        const int* u = arena.use(id);
+        uint64_t h = 1469598103934665603ULL;
+        for (int k = 0; k < d; k++) h = (h ^ (uint32_t)u[k]) * 1099511628211ULL;
+        return (size_t)h;
+    };
+    auto same = [&](int a, int b) { return memcmp(arena.use(a), arena.use(b), d * sizeof(int)) == 0; };
+
+    struct Ranked {
+        int id;
+        long long value;
+        long long total;  // Sum of the resources used
+    };
+    vector<int> candidates, kept, stack;
+    vector<Ranked> ranked;
+    DominanceTree tree(d);
+    for (int i = 0; i < n; i++) {
+        // Skip everywhere, take where it fits
+        candidates = live;
+        for (int id : live) {
+            const int* u = arena.use(id);
+            bool fits = true;
+            for (int k = 0; k < d && fits; k++) fits = (long long)u[k] + items[i].costs[k] <= caps[k];
+            if (fits) candidates.push_back(arena.add(id, items[i].costs, items[i].value, i));
+        }
+        result.visited += candidates.size();
+        ops.candidates += candidates.size();
+
+        // Equal vectors: keep the more valuable one (the older one on ties)
+        unordered_set<int, decltype(hash), decltype(same)> merged(candidates.size() * 2, hash, same);
+        for (int id : candidates) {
+            auto [at, inserted] = merged.insert(id);
+            if (!inserted && arena.value(id) > arena.value(*at)) {
+                merged.erase(at);
+                merged.insert(id);
+            }
+        }
+
+        ops.merges += (long long)candidates.size() - (long long)merged.size();
+
+        // Decreasing value, then increasing total use: whatever dominates a state comes before it
+        ranked.clear();
+        for (int id : merged) {
+            long long total = 0;
+            for (int k = 0; k < d; k++) total += arena.use(id)[k];
+            ranked.push_back({id, arena.value(id), total});
+        }
+        sort(ranked.begin(), ranked.end(), [](const Ranked& a, const Ranked& b) {
+            return a.value != b.value ? a.value > b.value : a.total < b.total;
+        });
+        kept.clear();
+        tree.clear();
+        for (const Ranked& r : ranked) {
+            if (tree.covers(arena.use(r.id), stack)) continue;
+            kept.push_back(r.id);
+            tree.insert(arena.use(r.id));
+        }
+        ops.pruned += (long long)ranked.size() - (long long)kept.size();
+        live.swap(kept);
+        result.peak = max(result.peak, (long long)live.size());
+        peakBytes = max(peakBytes, arena.bytes());
+        if (live.size() > MAX_STATES) {
+            error = "Too many non-dominated states";
+            return result;
+        }
+
+        // Dropped states stay in the arena until it has doubled since the last cleanup
+        if (arena.size() > 2 * compactedSize && arena.size() > 65536) {
+            arena.compact(live);
+            compactedSize = arena.size();
+        }
+    }
+    ops.cells += result.visited;
+
+    // Every live state fits; the best one is the answer
+    int best = live[0];
+    for (int id : live) {
+        if (arena.value(id) > arena.value(best)) best = id;
+    }
+    result.best = arena.value(best);
+    result.taken.assign(n, 0);
+    for (int id = best; arena.parentOf(id) >= 0; id = arena.parentOf(id)) result.taken[arena.itemOf(id)] = 1;
+    result.memoryBytes = peakBytes;
+    return result;
+}
+
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
+    auto startTime = chrono::high_resolution_clock::now();
+
+    // Format: knapsack_nd.exe <c1> ... <cd> <n> <w1,...,wd,v> ... [--storage=dense|sparse]
+    string storage = "auto";
+    vector<string> numbers;  // Limits, then n
+    int first = 1;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.rfind("--storage=", 0) == 0) storage = arg.substr(10);
+        else if (arg.find(',') == string::npos && arg.rfind("--", 0) != 0 && first == i) {
+            numbers.push_back(arg);
+            first = i + 1;
+        }
+    }
+    if (numbers.size() < 2) {
+        out << R"({"code":400,"error":"Insufficient parameters"})";
+        return 1;
+    }
+    if (storage != "auto" && storage != "dense" && storage != "sparse") {
+        out << R"({"code":400,"error":"Unknown storage, expected dense or sparse"})";
+        return 1;
+    }
+
+    int d = numbers.size() - 1;
+    vector<int> caps(d);
+    for (int k = 0; k < d; k++) caps[k] = stoi(numbers[k]);
+    int n = stoi(numbers[d]);
+
+    vector<Item> items(n);
+    for (int i = 0; i < n; i++) {
+        if (first + i >= argc) {
+            out << R"({"code":400,"error":"Insufficient parameters"})";
+            return 1;
+        }
+        stringstream fields(argv[first + i]);
+        string field;
+        vector<long long> parsed;
+        while (getline(fields, field, ',')) parsed.push_back(stoll(field));
+        if ((int)parsed.size() != d + 1) {
+            out << R"({"code":400,"error":"Each item needs one cost per limit and a value"})";
+            return 1;
+        }
+        items[i].costs.assign(parsed.begin(), parsed.end() - 1);
+        items[i].value = parsed[d];
+    }
+    // Cells and sparse states hold long long subset values, within the sum of |v|
+    knapsack_cells::int128 bound = 0;
+    for (const Item& item : items) bound += knapsack_cells::magnitude(item.value);
+    if (bound > LLONG_MAX) {
+        out << R"({"code":400,"error":"Total value exceeds the 64-bit range of the DP"})";
+        return 1;
+    }
+    for (int k = 0; k < d; k++) {
+        bool negative = caps[k] < 0;
+        for (const Item& item : items) negative = negative || item.costs[k] < 0;
+        if (negative) {
+            out << R"({"code":400,"error":"Limits and costs must be non-negative"})";
+            return 1;
+        }
+    }
+
+    // Points in the box, saturating once it could never be dense
+    profiler.enter(PREPROCESS);
+    long long cells = 1;
+    for (int k = 0; k < d; k++) cells = min(cells * (caps[k] + 1LL), DENSE_MAX_BYTES + 1);
+    long long denseBytes = cells * (long long)sizeof(long long) + (long long)n * ((cells + 63) / 64) * 8;
+    bool fewSubsets = n < 62 && (1LL << n) < cells;
+    bool dense = storage == "dense" || (storage == "auto" && denseBytes <= DENSE_MAX_BYTES && !fewSubsets);
+    if (dense && denseBytes > DENSE_MAX_BYTES) {
+        out << R"({"code":400,"error":"Capacity box too large for dense storage"})";
+        return 1;
+    }
+
+    profiler.enter(DP);
+    OpCounters ops;
+    string error;
+    Outcome result = dense ? solveDense(caps, items, cells, ops) : solveSparse(caps, items, ops, error);
+    if (!error.empty()) {
+        out << "{\"code\":400,\"error\":\"" << error << "\"}";
+        return 1;
+    }
+
+    profiler.enter(SERIALIZE);
+    JsonBuilder json;
+    json.startObject();
+
+    // d = 2 also carries knapsack_2d's fields, so its view can show the result
+    json.key("code"); json.value(200);
+    json.key("type"); json.value("Multi-Dimensional Cost");
+    json.key("dimensions"); json.value(d);
+    json.key("capacity"); json.value(caps[0]);
+    if (d == 2) { json.key("capacity2"); json.value(caps[1]); }
+    json.key("capacities");
+    json.startArray();
+    for (int c : caps) { json.nextItem(); json.value(c); }
+    json.endArray();
+
+    json.key("items");
+    json.startArray();
+    for (int i = 0; i < n; i++) {
+        json.nextItem();
+        json.startObject();
+        json.key("w"); json.value(items[i].costs[0]);
+        if (d == 2) { json.key("m"); json.value(items[i].costs[1]); }
+        json.key("v"); json.value(items[i].value);
+        json.key("costs");
+        json.startArray();
+        for (int c : items[i].costs) { json.nextItem(); json.value(c); }
+        json.endArray();
+        json.endObject();
+    }
+    json.endArray();
+
+    // No table to animate
+    json.key("steps");
+    json.startArray();
+    json.endArray();
+
+    // Last item first like knapsack_2d's backtrack: c = first resource left before the item is taken
+    json.key("path");
+    json.startArray();
+    long long left = caps[0];
+    for (int i = n; i > 0; i--) {
+        if (!result.taken[i - 1]) continue;
+        json.nextItem();
+        json.startObject();
+        json.key("r"); json.value(i);
+        json.key("c"); json.value(left);
+        json.key("item"); json.value(i - 1);
+        json.endObject();
+        left -= items[i - 1].costs[0];
+    }
+    json.endArray();
+
+    json.key("max_value"); json.value(result.best);
+
+    json.key("states");
+    json.startObject();
+    json.key("storage"); json.value(string(dense ? "dense" : "sparse"));
+    json.key("visited"); json.value(result.visited);
+    json.key("peak"); json.value(result.peak);
+    json.endObject();
+
+    auto endTime = chrono::high_resolution_clock::now();
+    double duration = chrono::duration<double, milli>(endTime - startTime).count();
+    json.key("time_ms"); json.value(duration);
+
+    json.key("complexity");
+    json.startObject();
+    json.key("time"); json.value(dense ? "O(n*C1*...*Cd)" : "O(n*S^2*d)");
+    json.key("space"); json.value(dense ? "O(C1*...*Cd*n/64)" : "O(S*d)");
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value(result.memoryBytes);
+    json.endObject();
+
+    // The root object stays open: the profile is appended after the body has been written
+    writeResult(json.str(), profiler, out);
+    return 0;
+}
+
+}  // namespace knapsack_nd
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_nd", knapsack_nd::run, argc, argv, cout);
+}
+#endif
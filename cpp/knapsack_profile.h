@@ -0,0 +1,284 @@
+/**
+ * Solver Profiling Support
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Per-phase wall/CPU timers, peak RSS and a counting global allocator shared by the solvers.
+ *              Each solver switches phases as it goes (parse, preprocess, dp, reconstruct, serialize, write)
+ *              and appends the "profile" object after its own JSON body has been written.
+ *              Every figure covers the instance the Profiler was created for: allocations are counted from
+ *              its construction on. Processes that run many instances (knapsack_lib, knapsack_batch,
+ *              knapsack_session) count allocations and CPU time on the calling thread only, so instances
+ *              on other workers do not leak in, and leave out peak RSS, which only exists per process; their
+ *              profiles say "scope":"thread". Threads a solver starts itself are not counted there
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+
+#include "knapsack_counters.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+namespace knapsack_profile {
+
+#if defined(KNAPSACK_LIBRARY) || defined(KNAPSACK_MULTI_INSTANCE)
+constexpr bool PER_THREAD = true;
+#else
+constexpr bool PER_THREAD = false;
+#endif
+
+struct AllocStats {
+    long long count;
+    long long bytes;
+    long long frees;
+    long long live;
+    long long peakLive;
+};
+
+// The calling thread's share of the counters below
+inline AllocStats& threadAllocs() {
+    static thread_local AllocStats stats = {};
+    return stats;
+}
+
+// Allocation counters, updated by the global operator new/delete below
+inline std::atomic<long long> allocCount{0};
+inline std::atomic<long long> allocBytes{0};
+inline std::atomic<long long> freeCount{0};
+inline std::atomic<long long> liveBytes{0};
+inline std::atomic<long long> peakLiveBytes{0};
+
+// Size header in front of every tracked block, keeps 16-byte alignment
+constexpr size_t HEADER = 16;
+
+// Both kept out of line: when GCC inlines the header arithmetic into container code it misreports
+// the header read in trackedFree as out of bounds / a mismatched free
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+inline void* trackedAlloc(size_t size) {
+    void* raw = std::malloc(size + HEADER);
+    if (!raw) return nullptr;
+    *static_cast<size_t*>(raw) = size;
+    allocCount.fetch_add(1, std::memory_order_relaxed);
+    allocBytes.fetch_add((long long)size, std::memory_order_relaxed);
+    long long live = liveBytes.fetch_add((long long)size, std::memory_order_relaxed) + (long long)size;
+    long long peak = peakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    AllocStats& mine = threadAllocs();
+    mine.count++;
+    mine.bytes += (long long)size;
+    mine.live += (long long)size;
+    mine.peakLive = std::max(mine.peakLive, mine.live);
+    return static_cast<char*>(raw) + HEADER;
+}
+
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+inline void trackedFree(void* p) {
+    if (!p) return;
+    void* raw = static_cast<char*>(p) - HEADER;
+    freeCount.fetch_add(1, std::memory_order_relaxed);
+    liveBytes.fetch_sub((long long)*static_cast<size_t*>(raw), std::memory_order_relaxed);
+    threadAllocs().frees++;
+    threadAllocs().live -= (long long)*static_cast<size_t*>(raw);
+    std::free(raw);
+}
+
+// CPU time in milliseconds: of the whole process (all threads), or of the calling thread where PER_THREAD
+inline double cpuNowMs() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (PER_THREAD) GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+    else GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+    auto toMs = [](const FILETIME& t) {
+        return (((unsigned long long)t.dwHighDateTime << 32) | t.dwLowDateTime) / 10000.0;
+    };
+    return toMs(kernel) + toMs(user);
+#else
+    timespec ts;
+    clock_gettime(PER_THREAD ? CLOCK_THREAD_CPUTIME_ID : CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+// Peak resident set size of the process in bytes
+inline long long peakRssBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return (long long)pmc.PeakWorkingSetSize;
+    return 0;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return (long long)usage.ru_maxrss;
+#else
+    return (long long)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+// Work a kernel actually did, as opposed to the closed-form bound. Every thread owns its own
+// instance (cache-line aligned, so threads never share a line) and the solver sums them at the end.
+struct alignas(64) OpCounters {
+    long long cells = 0;       // DP cells / states written
+    long long candidates = 0;  // Transitions compared
+    long long merges = 0;      // Lists, tables or subtrees merged
+    long long pruned = 0;      // States skipped as unreachable, dominated or out of bounds
+
+    OpCounters& operator+=(const OpCounters& o) {
+        cells += o.cells;
+        candidates += o.candidates;
+        merges += o.merges;
+        pruned += o.pruned;
+        return *this;
+    }
+};
+
+// Thrown at the next phase switch once the calling thread's cancel flag is set. Only the shared library
+// (knapsack_lib.cpp) installs a flag; the executables never see it
+struct Cancelled : std::exception {
+    const char* what() const noexcept override { return "cancelled"; }
+};
+
+inline const std::atomic<int>*& cancelFlag() {
+    static thread_local const std::atomic<int>* flag = nullptr;
+    return flag;
+}
+
+enum Phase { PARSE, PREPROCESS, DP, RECONSTRUCT, SERIALIZE, WRITE, PHASE_COUNT };
+
+inline const char* phaseName(int p) {
+    static const char* names[PHASE_COUNT] = {"parse", "preprocess", "dp", "reconstruct", "serialize", "write"};
+    return names[p];
+}
+
+// Accumulating phase timer. Phases may be entered repeatedly (e.g. dp and serialize alternate per row);
+// time spent in each is summed.
+class Profiler {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point start;
+    Clock::time_point mark;
+    double cpuStart;
+    double cpuMark;
+    int current;
+    double wallMs[PHASE_COUNT] = {};
+    double cpuMs[PHASE_COUNT] = {};
+    HardwareCounters counters;  // Count only while in the dp phase
+    long long dpCells = 0;
+    const char* kernel = nullptr;
+    AllocStats allocStart;  // Counters at construction; the peak restarts from the live bytes then
+
+    // Charge the time since the last switch to the current phase
+    void accumulate() {
+        Clock::time_point now = Clock::now();
+        double cpu = cpuNowMs();
+        wallMs[current] += std::chrono::duration<double, std::milli>(now - mark).count();
+        cpuMs[current] += cpu - cpuMark;
+        mark = now;
+        cpuMark = cpu;
+    }
+
+public:
+    Profiler() : start(Clock::now()), mark(start), cpuStart(cpuNowMs()), cpuMark(cpuStart), current(PARSE) {
+        allocStart = allocations();
+        if (PER_THREAD) threadAllocs().peakLive = allocStart.live;
+        else peakLiveBytes.store(allocStart.live);
+    }
+
+    // Current counters of this profile's scope
+    static AllocStats allocations() {
+        if (PER_THREAD) return threadAllocs();
+        return {allocCount.load(), allocBytes.load(), freeCount.load(), liveBytes.load(), peakLiveBytes.load()};
+    }
+
+    // Phase switches double as cancellation points: the row-by-row solvers switch once per DP row,
+    // the others at least between phases
+    void enter(Phase p) {
+        const std::atomic<int>* cancel = cancelFlag();
+        if (cancel && cancel->load(std::memory_order_relaxed)) throw Cancelled();
+        if (p == current) return;
+        if (current == DP) counters.pause();
+        accumulate();
+        current = p;
+        if (p == DP) counters.resume();
+    }
+
+    // DP cells evaluated, for the per-cell counter metrics
+    void setDpCells(long long cells) { dpCells = cells; }
+
+    // Name of the dispatched kernel variant (knapsack_kernels.h), for solvers that use one
+    void setKernel(const char* name) { kernel = name; }
+
+    // Closes the current phase and renders the profile object
+    std::string json() {
+        accumulate();
+        Clock::time_point now = mark;
+        double cpu = cpuMark;
+
+        std::stringstream ss;
+        ss << "{\"phases\":{";
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            if (p > 0) ss << ",";
+            ss << "\"" << phaseName(p) << "\":{\"wall_ms\":" << wallMs[p] << ",\"cpu_ms\":" << cpuMs[p] << "}";
+        }
+        ss << "},\"total_wall_ms\":" << std::chrono::duration<double, std::milli>(now - start).count();
+        ss << ",\"total_cpu_ms\":" << cpu - cpuStart;
+        ss << ",\"scope\":\"" << (PER_THREAD ? "thread" : "process") << "\"";
+        if (!PER_THREAD) ss << ",\"peak_rss_bytes\":" << peakRssBytes();
+        AllocStats allocs = allocations();
+        ss << ",\"allocations\":{\"count\":" << allocs.count - allocStart.count
+           << ",\"bytes\":" << allocs.bytes - allocStart.bytes << ",\"frees\":" << allocs.frees - allocStart.frees
+           << ",\"peak_live_bytes\":" << std::max(0LL, allocs.peakLive - allocStart.live) << "}";
+        if (kernel) ss << ",\"kernel\":\"" << kernel << "\"";
+        if (counters.enabled()) ss << ",\"counters\":" << counters.json(dpCells);
+        ss << "}";
+        return ss.str();
+    }
+};
+
+// Writes the result body (root object still open), then appends the profile and closes the object.
+// The profile's write phase therefore covers the body's write.
+inline void writeResult(const std::string& body, Profiler& profiler, std::ostream& out = std::cout) {
+    profiler.enter(WRITE);
+    out << body;
+    out.flush();
+    out << ",\"profile\":" << profiler.json() << "}";
+}
+
+}  // namespace knapsack_profile
+
+#ifndef KNAPSACK_NO_ALLOC_TRACKING
+// Replacement global allocation functions; the array, nothrow and sized forms forward here by default
+void* operator new(size_t size) {
+    void* p = knapsack_profile::trackedAlloc(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { knapsack_profile::trackedFree(p); }
+void operator delete(void* p, size_t) noexcept { knapsack_profile::trackedFree(p); }
+#endif
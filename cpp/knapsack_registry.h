@@ -0,0 +1,64 @@
+/**
+ * Solver Registry
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Every solver compiled into one translation unit, by executable name. Shared by the batch
+ *              runner and the solver library; the includer defines KNAPSACK_LIBRARY first so the solvers'
+ *              main() functions are left out and only run() remains
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "knapsack_cache.h"
+
+#include "knapsack_01.cpp"
+#include "knapsack_complete.cpp"
+#include "knapsack_multiple.cpp"
+#include "knapsack_mixed.cpp"
+#include "knapsack_2d.cpp"
+#include "knapsack_nd.cpp"
+#include "knapsack_2d_parallel.cpp"
+#include "knapsack_group.cpp"
+#include "knapsack_depend.cpp"
+#include "knapsack_tree.cpp"
+#include "knapsack_tree_parallel.cpp"
+#include "knapsack_kth.cpp"
+#include "knapsack_count.cpp"
+#include "knapsack_mitm.cpp"
+#include "knapsack_unbounded.cpp"
+#include "knapsack_rolling.cpp"
+#include "knapsack_fptas.cpp"
+#include "knapsack_value.cpp"
+#include "knapsack_dynamic.cpp"
+
+namespace knapsack_registry {
+
+using knapsack_cache::SolverFn;
+
+inline const std::map<std::string, SolverFn> SOLVERS = {
+    {"knapsack_01", knapsack_01::run},
+    {"knapsack_complete", knapsack_complete::run},
+    {"knapsack_multiple", knapsack_multiple::run},
+    {"knapsack_mixed", knapsack_mixed::run},
+    {"knapsack_2d", knapsack_2d::run},
+    {"knapsack_nd", knapsack_nd::run},
+    {"knapsack_2d_parallel", knapsack_2d_parallel::run},
+    {"knapsack_group", knapsack_group::run},
+    {"knapsack_depend", knapsack_depend::run},
+    {"knapsack_tree", knapsack_tree::run},
+    {"knapsack_tree_parallel", knapsack_tree_parallel::run},
+    {"knapsack_kth", knapsack_kth::run},
+    {"knapsack_count", knapsack_count::run},
+    {"knapsack_mitm", knapsack_mitm::run},
+    {"knapsack_unbounded", knapsack_unbounded::run},
+    {"knapsack_rolling", knapsack_rolling::run},
+    {"knapsack_fptas", knapsack_fptas::run},
+    {"knapsack_value", knapsack_value::run},
+    {"knapsack_dynamic", knapsack_dynamic::run},
+};
+
+}  // namespace knapsack_registry
@@ -0,0 +1,291 @@
+/**
+ * Complete / Mixed Knapsack Algorithm (Rolling Row, Solve Only)
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Solves complete knapsack, and mixed knapsack, in one DP row instead of an (n+1) x (C+1) table.
+ *              Complete items update the row in place with the stride-w kernel (knapsack_kernels.h): cells are
+ *              processed in blocks of w, which only read the finished block before them, so each block runs
+ *              as plain vector max operations. 0/1 and multiple items of the mixed model go first, through
+ *              the 0/1 row kernel and one decision bit per cell; complete items go last and need no bits,
+ *              since their choices can be read back from the final row itself. The row's cell type is the
+ *              narrowest one that holds the best total value (knapsack_cells.h)
+ *
+ * Input: Command line arguments, <capacity> <model> <n> followed by items in the format of the model's solver
+ *        (complete: w,v   mixed: w,v,type)
+ * Output: Standard output in JSON format (no animation steps; the path lists each chosen item once with its
+ *         count)
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_kernels.h"
+#include "knapsack_cells.h"
+
+using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_rolling {
+
+struct Item {
+    int weight;
+    long long value;
+    int type;  // 0 = 0/1, 1 = complete, 2 = multiple (3 copies, as in knapsack_mixed)
+};
+
+// Binary-decomposed piece of a bounded item
+struct SplitItem {
+    int weight;
+    long long value;
+    int originalIndex;
+    int splitCount;
+};
+
+class JsonBuilder {
+private:
+    stringstream ss;
+    bool firstItem = true;
+
+public:
+    void startObject() { ss << "{"; firstItem = true; }
+    void endObject() { ss << "}"; firstItem = false; }
+    void startArray() { ss << "["; firstItem = true; }
+    void endArray() { ss << "]"; firstItem = false; }
+
+    void key(const string& k) {
+        if (!firstItem) ss << ",";
+        ss << "\"" << k << "\":";
+        firstItem = false;
+    }
+
+    void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
+    void value(const string& v) { ss << "\"" << v << "\""; }
+    void value(double v) { ss << v; }
+    template <class T>
+    void cell(T v) { knapsack_cells::write(ss, v); }
+
+    void nextItem() {
+        if (!firstItem) ss << ",";
+        firstItem = false;
+    }
+
+    string str() { return ss.str(); }
+};
+
+// The DP for one cell type T, which holds every value the row can reach
+template <class T>
+int solve(int capacity, const string& model, const vector<Item>& items, Profiler& profiler,
+          chrono::high_resolution_clock::time_point startTime, ostream& out) {
+    int n = items.size();
+    OpCounters ops;
+    const knapsack_kernels::RowKernels<T>& kernels = knapsack_kernels::rowKernels<T>();  // Widest ISA of this host
+    profiler.setKernel(kernels.name);
+
+    // Bounded items as 0/1 pieces (same decomposition as knapsack_multiple), complete items kept whole
+    vector<SplitItem> pieces;
+    vector<int> unbounded;
+    for (int i = 0; i < n; i++) {
+        if (items[i].type == 1) {
+            unbounded.push_back(i);
+            continue;
+        }
+        int cnt = items[i].type == 2 ? 3 : 1;
+        for (int k = 1; k <= cnt; k *= 2) {
+            pieces.push_back({items[i].weight * k, items[i].value * k, i, k});
+            cnt -= k;
+        }
+        if (cnt > 0) {
+            pieces.push_back({items[i].weight * cnt, items[i].value * cnt, i, cnt});
+        }
+    }
+    int m = pieces.size();
+
+    // Bit j of took[i] = piece i improved column j, packed 64 to a word so recording it keeps up with the kernel
+    profiler.enter(DP);
+    vector<T> row(capacity + 1, T());
+    size_t words = (size_t)capacity / 64 + 1;
+    vector<vector<uint64_t>> took(m, vector<uint64_t>(words, 0));
+    if (m > 0) {
+        vector<T> next(capacity + 1);
+        for (int i = 0; i < m; i++) {
+            kernels.rowUpdate(row.data(), next.data(), capacity + 1, pieces[i].weight, (T)pieces[i].value);
+            for (size_t w = (size_t)pieces[i].weight / 64; w < words; w++) {
+                size_t end = min<size_t>(64, capacity + 1 - w * 64);
+                uint64_t bits = 0;
+                for (size_t b = 0; b < end; b++) bits |= (uint64_t)(next[w * 64 + b] != row[w * 64 + b]) << b;
+                took[i][w] = bits;
+            }
+            row.swap(next);
+            ops.cells += capacity + 1;
+            ops.candidates += capacity + 1 + max(0, capacity - pieces[i].weight + 1);
+        }
+    }
+
+    // The bounded part's row is the base the complete items build on
+    vector<T> base = m > 0 ? row : vector<T>();
+    for (int i : unbounded) {
+        kernels.unboundedRow(row.data(), capacity + 1, items[i].weight, (T)items[i].value);
+        ops.cells += capacity + 1;
+        ops.candidates += capacity + 1 + max(0, capacity - items[i].weight + 1);
+    }
+
+    // Complete items first, read off the final row: row[j] is either the base or row[j - w] + v of one of them
+    profiler.enter(RECONSTRUCT);
+    vector<long long> counts(n, 0);
+    int j = capacity;
+    bool found = true;
+    while (found && row[j] != (m > 0 ? base[j] : T())) {
+        found = false;
+        for (int i : unbounded) {
+            if (items[i].weight <= j && (T)(row[j - items[i].weight] + (T)items[i].value) == row[j]) {
+                counts[i]++;
+                j -= items[i].weight;
+                found = true;
+                break;
+            }
+        }
+    }
+    for (int i = m - 1; i >= 0 && j > 0; i--) {
+        if (took[i][j / 64] >> (j % 64) & 1) {
+            counts[pieces[i].originalIndex] += pieces[i].splitCount;
+            j -= pieces[i].weight;
+        }
+    }
+
+    profiler.enter(SERIALIZE);
+    JsonBuilder json;
+    json.startObject();
+
+    json.key("code"); json.value(200);
+    json.key("type"); json.value(model == "complete" ? "Complete Knapsack (Rolling Row)" :
+                                 "Mixed Knapsack (Rolling Row)");
+    json.key("capacity"); json.value(capacity);
+
+    json.key("items");
+    json.startArray();
+    for (int i = 0; i < n; i++) {
+        json.nextItem();
+        json.startObject();
+        json.key("w"); json.value(items[i].weight);
+        json.key("v"); json.value(items[i].value);
+        if (model == "mixed") { json.key("t"); json.value(items[i].type); }
+        json.endObject();
+    }
+    json.endArray();
+
+    // No DP table to animate
+    json.key("steps");
+    json.startArray();
+    json.endArray();
+
+    // Last item first, one entry per item: c = capacity left before its copies are taken
+    json.key("path");
+    json.startArray();
+    long long left = capacity;
+    for (int i = n; i > 0; i--) {
+        if (counts[i - 1] == 0) continue;
+        json.nextItem();
+        json.startObject();
+        json.key("r"); json.value(i);
+        json.key("c"); json.value(left);
+        json.key("item"); json.value(i - 1);
+        json.key("count"); json.value(counts[i - 1]);
+        json.endObject();
+        left -= counts[i - 1] * items[i - 1].weight;
+    }
+    json.endArray();
+
+    json.key("max_value"); json.cell(row[capacity]);
+    json.key("cell_type"); json.value(knapsack_cells::name<T>());
+
+    auto endTime = chrono::high_resolution_clock::now();
+    double duration = chrono::duration<double, milli>(endTime - startTime).count();
+    json.key("time_ms"); json.value(duration);
+
+    json.key("complexity");
+    json.startObject();
+    json.key("time"); json.value("O(n*C)");
+    json.key("space"); json.value("O(C)");
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes");
+    json.value((long long)((capacity + 1) * (m > 0 ? 3 : 1) * sizeof(T) + m * words * 8));
+    json.endObject();
+
+    // The root object stays open: the profile is appended after the body has been written
+    writeResult(json.str(), profiler, out);
+    return 0;
+}
+
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
+    auto startTime = chrono::high_resolution_clock::now();
+
+    // Format: knapsack_rolling.exe <capacity> <model> <n> <item1> <item2> ...
+    if (argc < 4) {
+        out << R"({"code":400,"error":"Insufficient parameters"})";
+        return 1;
+    }
+
+    int capacity = stoi(argv[1]);
+    string model = argv[2];
+    int n = stoi(argv[3]);
+
+    if (model != "complete" && model != "mixed") {
+        out << R"({"code":400,"error":"Unknown model, expected complete or mixed"})";
+        return 1;
+    }
+
+    vector<Item> items(n);
+    for (int i = 0; i < n && i + 4 < argc; i++) {
+        string arg = argv[i + 4];
+        size_t comma1 = arg.find(',');
+        size_t comma2 = arg.find(',', comma1 + 1);
+        items[i].weight = stoi(arg.substr(0, comma1));
+        if (comma2 == string::npos) {
+            items[i].value = stoll(arg.substr(comma1 + 1));
+            items[i].type = 1;
+        } else {
+            items[i].value = stoll(arg.substr(comma1 + 1, comma2 - comma1 - 1));
+            items[i].type = model == "mixed" ? stoi(arg.substr(comma2 + 1)) : 1;
+        }
+        if (items[i].weight <= 0) {
+            out << R"({"code":400,"error":"Items need a positive weight"})";
+            return 1;
+        }
+    }
+
+    // Bounded items add at most their copies' values; complete items fill at most the whole capacity at the
+    // best value/weight ratio among them. Every cell and candidate stays within the sum of the two
+    profiler.enter(PREPROCESS);
+    knapsack_cells::int128 bound = 0, unboundedBound = 0;
+    bool negative = false;
+    for (const Item& item : items) {
+        knapsack_cells::int128 v = item.value < 0 ? -(knapsack_cells::int128)item.value : item.value;
+        negative = negative || item.value < 0;
+        if (item.type == 1) unboundedBound = max(unboundedBound, max(v, v * capacity / item.weight));
+        else bound += v * (item.type == 2 ? 3 : 1);
+    }
+    return knapsack_cells::dispatch(bound + unboundedBound, negative, [&](auto zero) {
+        return solve<decltype(zero)>(capacity, model, items, profiler, startTime, out);
+    });
+}
+
+}  // namespace knapsack_rolling
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_rolling", knapsack_rolling::run, argc, argv, cout);
+}
+#endif
@@ -0,0 +1,341 @@
+/**
+ * Incremental 0/1 Knapsack Session
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Long-running 0/1 knapsack process that keeps the DP table of the current instance between
+ *              edits. Appending an item computes one row, raising the capacity computes only the new
+ *              columns, and editing or removing item i recomputes rows i..n, stopping early once a row
+ *              comes out unchanged. Each response carries only the steps of the cells it recomputed
+ *
+ * Usage: one command per line on stdin, one JSON line per command on stdout
+ *   reset <capacity> <n> <w1,v1> <w2,v2> ...   Start a new instance (full solve)
+ *   append <w,v>                                Add an item at the end
+ *   capacity <C>                                Change the capacity
+ *   edit <i> <w,v>                              Replace item i (0-based)
+ *   remove <i>                                  Delete item i (0-based)
+ *   quit
+ */
+
+// Many instances share this process: profiles count the calling thread from each command on
+#define KNAPSACK_MULTI_INSTANCE
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <climits>
+#include "knapsack_profile.h"
+#include "knapsack_cells.h"
+
+using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_session {
+
+struct Item {
+    int weight;
+    int value;
+};
+
+// JSON output builder (manual concatenation to avoid third-party libraries)
+class JsonBuilder {
+private:
+    stringstream ss;
+    bool firstItem = true;
+
+public:
+    void startObject() { ss << "{"; firstItem = true; }
+    void endObject() { ss << "}"; firstItem = false; }
+    void startArray() { ss << "["; firstItem = true; }
+    void endArray() { ss << "]"; firstItem = false; }
+
+    void key(const string& k) {
+        if (!firstItem) ss << ",";
+        ss << "\"" << k << "\":";
+        firstItem = false;
+    }
+
+    void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
+    void value(const string& v) { ss << "\"" << v << "\""; }
+    void value(double v) { ss << v; }
+
+    void nextItem() {
+        if (!firstItem) ss << ",";
+        firstItem = false;
+    }
+
+    string str() { return ss.str(); }
+};
+
+Item parseItem(const string& arg) {
+    size_t comma = arg.find(',');
+    if (comma == string::npos) throw invalid_argument("item must be w,v");
+    Item item{stoi(arg.substr(0, comma)), stoi(arg.substr(comma + 1))};
+    if (item.weight < 0) throw invalid_argument("negative weight");
+    return item;
+}
+
+// Every cell of the int table is a subset's value, within the sum of |v|: refuse items that could wrap it
+void requireIntTotal(const vector<Item>& items, const Item* added = nullptr, const Item* removed = nullptr) {
+    knapsack_cells::int128 total = 0;
+    for (const Item& item : items) total += knapsack_cells::magnitude(item.value);
+    if (added) total += knapsack_cells::magnitude(added->value);
+    if (removed) total -= knapsack_cells::magnitude(removed->value);
+    if (total > INT_MAX) throw invalid_argument("total value exceeds the int range of the DP");
+}
+
+class Session {
+private:
+    int capacity = 0;
+    vector<Item> items;
+    vector<vector<int>> dp;  // dp[0] is the all-zero row; dp[i] has capacity + 1 cells
+
+    // Cells lo..hi of a row from the row above
+    static void computeCells(const vector<int>& prev, vector<int>& row, const Item& item, int lo, int hi) {
+        for (int j = lo; j <= hi; j++) {
+            row[j] = prev[j];
+            if (j >= item.weight) row[j] = max(row[j], prev[j - item.weight] + item.value);
+        }
+    }
+
+    // Same step format as knapsack_01, so the renderer can patch its trace in place
+    void emitCells(JsonBuilder& json, int i, int lo, int hi) {
+        int w = items[i - 1].weight;
+        for (int j = lo; j <= hi; j++) {
+            json.nextItem();
+            json.startObject();
+            json.key("row"); json.value(i);
+            json.key("col"); json.value(j);
+            json.key("val"); json.value(dp[i][j]);
+            json.key("highlight");
+            json.startArray();
+            json.nextItem();
+            json.startObject();
+            json.key("r"); json.value(i - 1);
+            json.key("c"); json.value(j);
+            json.key("type"); json.value("without");
+            json.endObject();
+            if (j >= w) {
+                json.nextItem();
+                json.startObject();
+                json.key("r"); json.value(i - 1);
+                json.key("c"); json.value(j - w);
+                json.key("type"); json.value("with");
+                json.endObject();
+            }
+            json.endArray();
+            json.key("decision");
+            json.value(dp[i][j] == dp[i - 1][j] ? "skip" : "take");
+            json.endObject();
+        }
+    }
+
+public:
+    // Apply one command and write its response; returns false on "quit"
+    bool command(const string& line, ostream& out) {
+        Profiler profiler;
+        auto startTime = chrono::high_resolution_clock::now();
+
+        stringstream ss(line);
+        string op;
+        ss >> op;
+        if (op == "quit") return false;
+
+        // Parse everything before touching the state, so a bad command leaves the session intact
+        int firstRow = 1, lastRow = 0, lo = 0, hi = capacity;
+        bool stopWhenUnchanged = false;  // Only valid when the stored rows below were built from the stored row above
+        string formula;
+        if (op == "reset") {
+            int c, n;
+            ss >> c >> n;
+            if (!ss || c < 0 || n < 0) throw invalid_argument("reset <capacity> <n> <w,v>...");
+            vector<Item> parsed(n);
+            for (int i = 0; i < n; i++) {
+                string arg;
+                if (!(ss >> arg)) throw invalid_argument("missing items");
+                parsed[i] = parseItem(arg);
+            }
+            requireIntTotal(parsed);
+            capacity = c;
+            items = move(parsed);
+            dp.assign(n + 1, vector<int>(capacity + 1, 0));
+            lastRow = n;
+            hi = capacity;
+            formula = "O(n*C)";
+        } else if (op == "append") {
+            string arg;
+            if (!(ss >> arg)) throw invalid_argument("append <w,v>");
+            Item item = parseItem(arg);
+            requireIntTotal(items, &item);
+            if (dp.empty()) dp.assign(1, vector<int>(capacity + 1, 0));
+            items.push_back(item);
+            dp.emplace_back(capacity + 1, 0);
+            firstRow = lastRow = (int)items.size();
+            formula = "O(C)";
+        } else if (op == "capacity") {
+            int c;
+            if (!(ss >> c) || c < 0) throw invalid_argument("capacity <C>");
+            if (dp.empty()) dp.assign(1, vector<int>(1, 0));
+            for (auto& row : dp) row.resize(c + 1, 0);
+            // Growing computes only the new columns; shrinking just truncates
+            if (c > capacity) {
+                lastRow = (int)items.size();
+                lo = capacity + 1;
+                hi = c;
+            }
+            capacity = c;
+            formula = "O(n*(C'-C))";
+        } else if (op == "edit" || op == "remove") {
+            int index;
+            if (!(ss >> index) || index < 0 || index >= (int)items.size()) throw invalid_argument("item index out of range");
+            if (op == "edit") {
+                string arg;
+                if (!(ss >> arg)) throw invalid_argument("edit <i> <w,v>");
+                Item item = parseItem(arg);
+                requireIntTotal(items, &item, &items[index]);
+                items[index] = item;
+            } else {
+                items.erase(items.begin() + index);
+                dp.erase(dp.begin() + index + 1);
+            }
+            firstRow = index + 1;
+            lastRow = (int)items.size();
+            stopWhenUnchanged = true;
+            formula = "O((n-i)*C)";
+        } else {
+            throw invalid_argument("unknown command: " + op);
+        }
+
+        int n = (int)items.size();
+        OpCounters ops;
+
+        profiler.enter(DP);
+        int changedLast = firstRow - 1;
+        vector<int> scratch;
+        for (int i = firstRow; i <= lastRow; i++) {
+            if (stopWhenUnchanged) {
+                scratch = dp[i];
+                computeCells(dp[i - 1], scratch, items[i - 1], lo, hi);
+                ops.cells += hi - lo + 1;
+                // Rows below were built from this row's old contents with unchanged items
+                if (scratch == dp[i]) {
+                    ops.pruned += (long long)(lastRow - i) * (hi - lo + 1);
+                    break;
+                }
+                dp[i].swap(scratch);
+            } else {
+                computeCells(dp[i - 1], dp[i], items[i - 1], lo, hi);
+                ops.cells += hi - lo + 1;
+            }
+            ops.candidates += (hi - lo + 1) + max(0, hi - max(lo, items[i - 1].weight) + 1);
+            changedLast = i;
+        }
+        profiler.setDpCells(ops.cells);
+
+        profiler.enter(SERIALIZE);
+        JsonBuilder json;
+        json.startObject();
+        json.key("code"); json.value(200);
+        json.key("type"); json.value("0/1 Knapsack");
+        json.key("op"); json.value(op);
+        json.key("capacity"); json.value(capacity);
+
+        json.key("items");
+        json.startArray();
+        for (const Item& item : items) {
+            json.nextItem();
+            json.startObject();
+            json.key("w"); json.value(item.weight);
+            json.key("v"); json.value(item.value);
+            json.endObject();
+        }
+        json.endArray();
+
+        // Rows firstRow..changedLast over columns lo..hi were recomputed and changed
+        json.key("delta");
+        json.startObject();
+        json.key("rows");
+        json.startArray();
+        json.nextItem(); json.value(firstRow);
+        json.nextItem(); json.value(changedLast);
+        json.endArray();
+        json.key("cols");
+        json.startArray();
+        json.nextItem(); json.value(lo);
+        json.nextItem(); json.value(hi);
+        json.endArray();
+        json.endObject();
+
+        json.key("steps");
+        json.startArray();
+        for (int i = firstRow; i <= changedLast; i++) emitCells(json, i, lo, hi);
+        json.endArray();
+
+        profiler.enter(RECONSTRUCT);
+        vector<pair<int, int>> path;
+        int j = capacity;
+        for (int i = n; i > 0; i--) {  // Zero-weight items can still be taken at j = 0
+            if (dp[i][j] != dp[i - 1][j]) {
+                path.push_back({i, j});
+                j -= items[i - 1].weight;
+            }
+        }
+
+        profiler.enter(SERIALIZE);
+        json.key("path");
+        json.startArray();
+        for (auto& [r, c] : path) {
+            json.nextItem();
+            json.startObject();
+            json.key("r"); json.value(r);
+            json.key("c"); json.value(c);
+            json.key("item"); json.value(r - 1);
+            json.endObject();
+        }
+        json.endArray();
+
+        json.key("max_value"); json.value(dp.empty() ? 0 : dp[n][capacity]);
+
+        auto endTime = chrono::high_resolution_clock::now();
+        json.key("time_ms"); json.value(chrono::duration<double, milli>(endTime - startTime).count());
+
+        json.key("complexity");
+        json.startObject();
+        json.key("time"); json.value(formula);
+        json.key("space"); json.value("O(n*C)");
+        json.key("operations"); json.value(ops.candidates);
+        json.key("cells"); json.value(ops.cells);
+        json.key("candidates"); json.value(ops.candidates);
+        json.key("merges"); json.value(ops.merges);
+        json.key("pruned"); json.value(ops.pruned);
+        json.key("memory_bytes"); json.value((long long)(n + 1) * (capacity + 1) * 4);
+        json.endObject();
+
+        writeResult(json.str(), profiler, out);
+        out << "\n";
+        out.flush();
+        return true;
+    }
+};
+
+}  // namespace knapsack_session
+
+int main() {
+    knapsack_session::Session session;
+    string line;
+    while (getline(cin, line)) {
+        if (line.find_first_not_of(" \t\r") == string::npos) continue;
+        try {
+            if (!session.command(line, cout)) break;
+        } catch (const exception& e) {
+            cout << "{\"code\":400,\"error\":\"" << e.what() << "\"}\n";
+            cout.flush();
+        }
+    }
+    return 0;
+}
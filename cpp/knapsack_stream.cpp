@@ -0,0 +1,324 @@
+/**
+ * Paginated Step Generator (0/1 and Complete Knapsack)
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Produces the animation steps of knapsack_01 / knapsack_complete on demand instead of all at
+ *              once. The generator is an explicit state machine over (row, col): a row of the DP table is
+ *              computed only when the first of its steps is requested, and each request is capped at
+ *              MAX_PAGE steps, so work and memory follow what the viewer has actually pulled.
+ *              The run can be cancelled at any point
+ *
+ * Input: Command line arguments, <capacity> <model> <n> <w1,v1> <w2,v2> ...   (model: 01 | complete)
+ *        then one command per line on stdin
+ *          next <N>   Emit up to N further steps
+ *          cancel     Stop and exit
+ * Output: A header line (items, total_steps), then one JSON line per "next":
+ *         {"from":s,"steps":[...],"done":false}; the page with the last step also carries path, max_value,
+ *         time_ms, complexity and profile
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <climits>
+#include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_cells.h"
+
+using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_stream {
+
+// Upper bound on one page, so a single request cannot force the whole trace into memory
+const int MAX_PAGE = 65536;
+
+struct Item {
+    int weight;
+    int value;
+};
+
+class JsonBuilder {
+private:
+    stringstream ss;
+    bool firstItem = true;
+
+public:
+    void startObject() { ss << "{"; firstItem = true; }
+    void endObject() { ss << "}"; firstItem = false; }
+    void startArray() { ss << "["; firstItem = true; }
+    void endArray() { ss << "]"; firstItem = false; }
+
+    void key(const string& k) {
+        if (!firstItem) ss << ",";
+        ss << "\"" << k << "\":";
+        firstItem = false;
+    }
+
+    void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
+    void value(const string& v) { ss << "\"" << v << "\""; }
+    void value(double v) { ss << v; }
+    void raw(const string& v) { ss << v; }
+
+    void nextItem() {
+        if (!firstItem) ss << ",";
+        firstItem = false;
+    }
+
+    string str() { return ss.str(); }
+};
+
+class StepGenerator {
+private:
+    int capacity;
+    bool complete;  // Complete knapsack takes from the current row instead of the row above
+    vector<Item> items;
+    vector<vector<int>> dp;  // Rows 0..computedRows exist
+    int computedRows = 0;
+    int row = 1;  // Cursor: the next step is (row, col)
+    int col = 0;
+    long long emitted = 0;
+    OpCounters ops;
+
+    void computeRow(int i) {
+        int w = items[i - 1].weight;
+        int v = items[i - 1].value;
+        dp.emplace_back(capacity + 1, 0);
+        for (int j = 0; j <= capacity; j++) {
+            dp[i][j] = dp[i - 1][j];
+            if (j >= w) dp[i][j] = max(dp[i][j], (complete ? dp[i][j - w] : dp[i - 1][j - w]) + v);
+        }
+        ops.cells += capacity + 1;
+        ops.candidates += capacity + 1 + max(0, capacity - w + 1);
+        computedRows = i;
+    }
+
+    void emitStep(JsonBuilder& json, int i, int j) {
+        int w = items[i - 1].weight;
+        json.nextItem();
+        json.startObject();
+        json.key("row"); json.value(i);
+        json.key("col"); json.value(j);
+        json.key("val"); json.value(dp[i][j]);
+        json.key("highlight");
+        json.startArray();
+        json.nextItem();
+        json.startObject();
+        json.key("r"); json.value(i - 1);
+        json.key("c"); json.value(j);
+        json.key("type"); json.value("without");
+        json.endObject();
+        if (j >= w) {
+            json.nextItem();
+            json.startObject();
+            json.key("r"); json.value(complete ? i : i - 1);
+            json.key("c"); json.value(j - w);
+            json.key("type"); json.value("with");
+            json.endObject();
+        }
+        json.endArray();
+        json.key("decision");
+        json.value(j < w || dp[i][j] == dp[i - 1][j] ? "skip" : "take");
+        json.endObject();
+    }
+
+public:
+    StepGenerator(int capacity, bool complete, vector<Item> items)
+        : capacity(capacity), complete(complete), items(move(items)), dp(1, vector<int>(capacity + 1, 0)) {}
+
+    int n() const { return (int)items.size(); }
+    long long totalSteps() const { return (long long)n() * (capacity + 1); }
+    long long position() const { return emitted; }
+    bool done() const { return row > n(); }
+    const OpCounters& counters() const { return ops; }
+
+    // Advance the state machine by up to count steps, computing rows as the cursor enters them
+    void next(int count, JsonBuilder& json, Profiler& profiler) {
+        for (int k = 0; k < count && !done(); k++) {
+            if (computedRows < row) {
+                profiler.enter(DP);
+                computeRow(row);
+                profiler.enter(SERIALIZE);
+            }
+            emitStep(json, row, col);
+            emitted++;
+            if (++col > capacity) {
+                col = 0;
+                row++;
+            }
+        }
+    }
+
+    vector<pair<int, int>> path() const {
+        vector<pair<int, int>> taken;
+        int j = capacity;
+        for (int i = n(); i > 0 && j > 0;) {
+            if (dp[i][j] != dp[i - 1][j]) {
+                taken.push_back({i, j});
+                j -= items[i - 1].weight;
+                if (!complete) i--;
+            } else {
+                i--;
+            }
+        }
+        return taken;
+    }
+
+    int maxValue() const { return dp[n()][capacity]; }
+};
+
+int run(int argc, char* argv[], istream& in, ostream& out) {
+    auto startTime = chrono::high_resolution_clock::now();
+
+    // Format: knapsack_stream.exe <capacity> <model> <n> <w1,v1> ...
+    if (argc < 4) {
+        out << R"({"code":400,"error":"Insufficient parameters"})" << "\n";
+        return 1;
+    }
+
+    int capacity = stoi(argv[1]);
+    string model = argv[2];
+    int n = stoi(argv[3]);
+
+    if (model != "01" && model != "complete") {
+        out << R"({"code":400,"error":"Unknown model, expected 01 or complete"})" << "\n";
+        return 1;
+    }
+
+    vector<Item> items(n);
+    for (int i = 0; i < n && i + 4 < argc; i++) {
+        string arg = argv[i + 4];
+        size_t comma = arg.find(',');
+        items[i].weight = stoi(arg.substr(0, comma));
+        items[i].value = stoi(arg.substr(comma + 1));
+        if (items[i].weight < (model == "complete" ? 1 : 0)) {
+            out << R"({"code":400,"error":"Invalid item weight"})" << "\n";
+            return 1;
+        }
+    }
+
+    // Cells stay within the sum of |v| (0/1) or the capacity filled at the best value/weight ratio
+    // (complete); the int table must hold it
+    knapsack_cells::int128 bound = 0;
+    for (const Item& item : items) {
+        knapsack_cells::int128 v = knapsack_cells::magnitude(item.value);
+        if (model == "01") bound += v;
+        else bound = max(bound, max(v, v * capacity / item.weight));
+    }
+    if (bound > INT_MAX) {
+        out << R"({"code":400,"error":"Total value exceeds the int range of the DP"})" << "\n";
+        return 1;
+    }
+
+    StepGenerator generator(capacity, model == "complete", items);
+
+    // Header: everything the viewer needs before the first step
+    {
+        JsonBuilder json;
+        json.startObject();
+        json.key("code"); json.value(200);
+        json.key("type"); json.value(model == "01" ? "0/1 Knapsack" : "Complete Knapsack");
+        json.key("capacity"); json.value(capacity);
+        json.key("items");
+        json.startArray();
+        for (const Item& item : items) {
+            json.nextItem();
+            json.startObject();
+            json.key("w"); json.value(item.weight);
+            json.key("v"); json.value(item.value);
+            json.endObject();
+        }
+        json.endArray();
+        json.key("total_steps"); json.value(generator.totalSteps());
+        json.key("page_limit"); json.value(MAX_PAGE);
+        json.endObject();
+        out << json.str() << "\n";
+        out.flush();
+    }
+
+    bool finished = false;  // The result has been sent with the last page
+    string line;
+    while (getline(in, line)) {
+        stringstream ss(line);
+        string command;
+        if (!(ss >> command)) continue;
+        if (command == "cancel") break;
+        if (command != "next") {
+            out << R"({"code":400,"error":"Unknown command"})" << "\n";
+            out.flush();
+            continue;
+        }
+
+        int count = 0;
+        ss >> count;
+        count = max(0, min(count, MAX_PAGE));
+
+        // One profiler per page: its phases cover the rows computed and the steps written for this request
+        Profiler profiler;
+        profiler.enter(SERIALIZE);
+        JsonBuilder json;
+        json.startObject();
+        json.key("from"); json.value(generator.position());
+        json.key("steps");
+        json.startArray();
+        generator.next(count, json, profiler);
+        json.endArray();
+        json.key("done"); json.raw(generator.done() ? "true" : "false");
+
+        if (!generator.done() || finished) {
+            json.endObject();
+            out << json.str() << "\n";
+            out.flush();
+            continue;
+        }
+
+        // The page that finishes the trace carries the result
+        profiler.enter(RECONSTRUCT);
+        vector<pair<int, int>> path = generator.path();
+        profiler.enter(SERIALIZE);
+        json.key("path");
+        json.startArray();
+        for (auto& [r, c] : path) {
+            json.nextItem();
+            json.startObject();
+            json.key("r"); json.value(r);
+            json.key("c"); json.value(c);
+            json.key("item"); json.value(r - 1);
+            json.endObject();
+        }
+        json.endArray();
+        json.key("max_value"); json.value(generator.maxValue());
+
+        auto endTime = chrono::high_resolution_clock::now();
+        json.key("time_ms"); json.value(chrono::duration<double, milli>(endTime - startTime).count());
+
+        const OpCounters& ops = generator.counters();
+        json.key("complexity");
+        json.startObject();
+        json.key("time"); json.value("O(n*C)");
+        json.key("space"); json.value("O(n*C)");
+        json.key("operations"); json.value(ops.candidates);
+        json.key("cells"); json.value(ops.cells);
+        json.key("candidates"); json.value(ops.candidates);
+        json.key("merges"); json.value(ops.merges);
+        json.key("pruned"); json.value(ops.pruned);
+        json.key("memory_bytes"); json.value((long long)(n + 1) * (capacity + 1) * 4);
+        json.endObject();
+
+        writeResult(json.str(), profiler, out);
+        out << "\n";
+        out.flush();
+        finished = true;
+    }
+    return 0;
+}
+
+}  // namespace knapsack_stream
+
+int main(int argc, char* argv[]) {
+    return knapsack_stream::run(argc, argv, cin, cout);
+}
@@ -0,0 +1,140 @@
+/**
+ * DP Table Query Tool
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Reads a DP table that a solver left in a row store file (row_store.h) without loading it:
+ *              the file is mapped read-only and only the requested rows are paged in. Cells are read by
+ *              their size in the header: 2 = uint16, 4 = int32, 8 = int64, 16 = int128 (knapsack_cells.h)
+ *
+ * Input: Command line arguments, <file> <command>
+ *          info                      Header: solver, rows, cols, cell size
+ *          row <i> [<from> <to>]     Cells [from, to] of row i (whole row by default)
+ *          cell <i> <j>              One cell
+ *          delete                    Remove the file once nobody needs it any more (only a row store file)
+ * Output: Standard output in JSON format
+ */
+
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <cstring>
+#include <filesystem>
+#include "row_store.h"
+#include "knapsack_cells.h"
+
+using namespace std;
+
+namespace knapsack_table {
+
+class Table {
+private:
+    MappedFile file;
+    knapsack_rows::TableHeader header = {};
+
+public:
+    explicit Table(const string& path) : file(path) {
+        if (!file.valid() || file.size() < knapsack_rows::HEADER_BYTES) throw runtime_error("Cannot open table");
+        memcpy(&header, file.data(), sizeof(header));
+        if (memcmp(header.magic, knapsack_rows::MAGIC, sizeof(knapsack_rows::MAGIC)) != 0 ||
+            header.version != knapsack_rows::VERSION) {
+            throw runtime_error("Not a row store file");
+        }
+        if (header.cellBytes != 2 && header.cellBytes != 4 && header.cellBytes != 8 && header.cellBytes != 16) {
+            throw runtime_error("Unsupported cell size");
+        }
+        if (file.size() < knapsack_rows::HEADER_BYTES + header.rows * header.cols * header.cellBytes) {
+            throw runtime_error("Table file truncated");
+        }
+#ifndef _WIN32
+        madvise(const_cast<char*>(file.data()), file.size(), MADV_RANDOM);  // Queries jump between rows
+#endif
+    }
+
+    size_t rows() const { return header.rows; }
+    size_t cols() const { return header.cols; }
+
+    template <class T>
+    static knapsack_cells::int128 load(const char* p) {
+        T v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    knapsack_cells::int128 cell(size_t i, size_t j) const {
+        const char* p = file.data() + knapsack_rows::HEADER_BYTES + (i * header.cols + j) * header.cellBytes;
+        switch (header.cellBytes) {
+            case 2: return load<uint16_t>(p);
+            case 4: return load<int32_t>(p);
+            case 8: return load<int64_t>(p);
+            default: return load<knapsack_cells::int128>(p);
+        }
+    }
+
+    string info() const {
+        stringstream ss;
+        ss << "{\"code\":200,\"solver\":\"" << string(header.solver, strnlen(header.solver, sizeof(header.solver)))
+           << "\",\"rows\":" << header.rows << ",\"cols\":" << header.cols << ",\"cell_bytes\":" << header.cellBytes
+           << "}";
+        return ss.str();
+    }
+};
+
+size_t index(const string& arg, size_t limit, const char* what) {
+    size_t v = stoull(arg);
+    if (v >= limit) throw runtime_error(string(what) + " out of range");
+    return v;
+}
+
+int run(int argc, char* argv[], ostream& out) {
+    if (argc < 3) {
+        out << "{\"code\":400,\"error\":\"Usage: knapsack_table <file> info|row|cell|delete\"}";
+        return 1;
+    }
+    string path = argv[1];
+    string command = argv[2];
+
+    if (command == "delete") {
+        { Table check(path); }  // Throws unless the file is a row store table; unmapped before removal
+        error_code ec;
+        bool removed = filesystem::remove(path, ec);
+        out << "{\"code\":200,\"deleted\":" << (removed ? "true" : "false") << "}";
+        return 0;
+    }
+
+    Table table(path);
+    if (command == "info") {
+        out << table.info();
+    } else if (command == "row" && argc >= 4) {
+        size_t i = index(argv[3], table.rows(), "Row");
+        size_t from = argc >= 6 ? index(argv[4], table.cols(), "Column") : 0;
+        size_t to = argc >= 6 ? index(argv[5], table.cols(), "Column") : table.cols() - 1;
+        out << "{\"code\":200,\"row\":" << i << ",\"from\":" << from << ",\"values\":[";
+        for (size_t j = from; j <= to; j++) {
+            if (j > from) out << ",";
+            knapsack_cells::write(out, table.cell(i, j));
+        }
+        out << "]}";
+    } else if (command == "cell" && argc >= 5) {
+        size_t i = index(argv[3], table.rows(), "Row");
+        size_t j = index(argv[4], table.cols(), "Column");
+        out << "{\"code\":200,\"row\":" << i << ",\"col\":" << j << ",\"value\":";
+        knapsack_cells::write(out, table.cell(i, j));
+        out << "}";
+    } else {
+        out << "{\"code\":400,\"error\":\"Unknown command: " << command << "\"}";
+        return 1;
+    }
+    return 0;
+}
+
+}  // namespace knapsack_table
+
+int main(int argc, char* argv[]) {
+    try {
+        return knapsack_table::run(argc, argv, cout);
+    } catch (const exception& e) {
+        cout << "{\"code\":400,\"error\":\"" << e.what() << "\"}";
+        return 1;
+    }
+}
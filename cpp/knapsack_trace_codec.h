@@ -0,0 +1,139 @@
+/**
+ * Packed Trace Encoding
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Compact replacement for the per-cell step objects, requested with a trailing --trace=packed
+ *              argument. A trace is a sequence of table rows, each stored as its difference to a base row
+ *              (the previous DP row, or the node's previous snapshot for the tree solver). The differences
+ *              are written as tokens, each a varint header (length << 2 | kind) followed by its payload:
+ *                kind 0  skip    length cells unchanged, no payload
+ *                kind 1  repeat  length cells changed by the same amount, one zigzag varint
+ *                kind 2  literal length zigzag varints, one per cell
+ *              In a 0/1 row most cells inherit from the row above, so rows shrink to a few bytes. The bytes
+ *              are base64-encoded into "trace":{"encoding","base","rows","cols","bytes","data"}; the viewer
+ *              rebuilds the steps with src/renderer/src/utils/traceCodec.js
+ */
+
+#pragma once
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+namespace knapsack_trace {
+
+inline bool packedRequested(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--trace=packed") == 0) return true;
+    }
+    return false;
+}
+
+// --trace=none: no steps at all, only the result (for tables too large to animate)
+inline bool stepsOmitted(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--trace=none") == 0) return true;
+    }
+    return false;
+}
+
+inline std::string base64(const std::string& bytes) {
+    static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string r;
+    r.reserve((bytes.size() + 2) / 3 * 4);
+    size_t i = 0;
+    for (; i + 2 < bytes.size(); i += 3) {
+        unsigned v = (unsigned char)bytes[i] << 16 | (unsigned char)bytes[i + 1] << 8 | (unsigned char)bytes[i + 2];
+        r += alphabet[v >> 18];
+        r += alphabet[(v >> 12) & 63];
+        r += alphabet[(v >> 6) & 63];
+        r += alphabet[v & 63];
+    }
+    if (i < bytes.size()) {
+        unsigned v = (unsigned char)bytes[i] << 16 | (i + 1 < bytes.size() ? (unsigned char)bytes[i + 1] << 8 : 0);
+        r += alphabet[v >> 18];
+        r += alphabet[(v >> 12) & 63];
+        r += i + 1 < bytes.size() ? alphabet[(v >> 6) & 63] : '=';
+        r += '=';
+    }
+    return r;
+}
+
+class DeltaEncoder {
+private:
+    enum Kind { SKIP = 0, REPEAT = 1, LITERAL = 2 };
+
+    // Shorter runs of one difference are cheaper as literals
+    static constexpr size_t MIN_REPEAT = 3;
+
+    int cols;
+    const char* base;
+    long long rowCount = 0;
+    std::string bytes;
+
+    void varint(unsigned long long v) {
+        while (v >= 0x80) {
+            bytes += (char)((v & 0x7f) | 0x80);
+            v >>= 7;
+        }
+        bytes += (char)v;
+    }
+
+    void zigzag(long long v) { varint(((unsigned long long)v << 1) ^ (unsigned long long)(v >> 63)); }
+
+    void token(Kind kind, size_t length) { varint(((unsigned long long)length << 2) | kind); }
+
+public:
+    // base names what each row is a difference to, for the decoder: "row" or "node"
+    DeltaEncoder(int cols, const char* base) : cols(cols), base(base) {}
+
+    // Append cur as a difference to prev; a null prev is a row of zeros
+    template <class T>
+    void row(const T* prev, const T* cur) {
+        // Cells wider than long long subtract in their own type; the difference itself fits a long long
+        typedef typename std::conditional<(sizeof(T) > sizeof(long long)), T, long long>::type Wide;
+        auto delta = [&](size_t j) { return (long long)((Wide)cur[j] - (prev ? (Wide)prev[j] : Wide())); };
+        auto repeatsAt = [&](size_t j) {
+            if (j + MIN_REPEAT > (size_t)cols) return false;
+            long long d = delta(j);
+            for (size_t k = 1; k < MIN_REPEAT; k++) {
+                if (delta(j + k) != d) return false;
+            }
+            return true;
+        };
+
+        size_t j = 0;
+        while (j < (size_t)cols) {
+            long long d = delta(j);
+            size_t k = j + 1;
+            while (k < (size_t)cols && delta(k) == d) k++;
+            if (d == 0) {
+                token(SKIP, k - j);
+            } else if (k - j >= MIN_REPEAT) {
+                token(REPEAT, k - j);
+                zigzag(d);
+            } else {
+                // Literal up to the next unchanged cell or run worth a repeat token
+                k = j + 1;
+                while (k < (size_t)cols && delta(k) != 0 && !repeatsAt(k)) k++;
+                token(LITERAL, k - j);
+                for (size_t m = j; m < k; m++) zigzag(delta(m));
+            }
+            j = k;
+        }
+        rowCount++;
+    }
+
+    size_t size() const { return bytes.size(); }
+
+    std::string json() const {
+        std::stringstream ss;
+        ss << "{\"encoding\":\"zigzag-rle\",\"base\":\"" << base << "\",\"rows\":" << rowCount << ",\"cols\":" << cols
+           << ",\"bytes\":" << bytes.size() << ",\"data\":\"" << base64(bytes) << "\"}";
+        return ss.str();
+    }
+};
+
+}  // namespace knapsack_trace
@@ -0,0 +1,79 @@
+/**
+ * Result Transport
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Entry point shared by every solver's main(). With KNAPSACK_TRANSPORT_DIR set, a result of at
+ *              least KNAPSACK_TRANSPORT_MIN_BYTES (default 64 KB) is written into a memory-mapped file in
+ *              that directory and only a descriptor goes to stdout:
+ *                {"transport":"file","path":"...","bytes":N}
+ *              The reader owns the file and deletes it. Smaller results, errors and runs without the
+ *              variable are written to stdout as before
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+#include "knapsack_cache.h"
+#include "mapped_file.h"
+
+namespace knapsack_transport {
+
+constexpr size_t DEFAULT_MIN_BYTES = 64 * 1024;
+
+inline long long processId() {
+#ifdef _WIN32
+    return (long long)GetCurrentProcessId();
+#else
+    return (long long)getpid();
+#endif
+}
+
+// Paths end up inside a JSON string (backslashes on Windows)
+inline std::string escape(const std::string& s) {
+    std::string r;
+    for (char c : s) {
+        if (c == '"' || c == '\\') r += '\\';
+        r += c;
+    }
+    return r;
+}
+
+inline int deliver(const char* solver, knapsack_cache::SolverFn run, int argc, char* argv[], std::ostream& out) {
+    const char* dir = std::getenv("KNAPSACK_TRANSPORT_DIR");
+    if (!dir || !*dir) return knapsack_cache::cachedRun(solver, run, argc, argv, out);
+
+    size_t minBytes = DEFAULT_MIN_BYTES;
+    if (const char* m = std::getenv("KNAPSACK_TRANSPORT_MIN_BYTES")) minBytes = std::strtoull(m, nullptr, 10);
+
+    std::stringstream captured;
+    int code = knapsack_cache::cachedRun(solver, run, argc, argv, captured);
+    std::string result = captured.str();
+    if (code != 0 || result.size() < minBytes) {
+        out << result;
+        return code;
+    }
+
+    std::filesystem::path path = std::filesystem::path(dir) /
+        (std::string(solver) + "-" + std::to_string(processId()) + "-" +
+         std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".json");
+    {
+        MappedFile file = MappedFile::create(path.string(), result.size());
+        if (!file.valid()) {
+            out << result;  // No usable directory: fall back to the pipe
+            return code;
+        }
+        std::memcpy(file.data(), result.data(), result.size());
+    }
+    out << "{\"transport\":\"file\",\"path\":\"" << escape(path.string()) << "\",\"bytes\":" << result.size() << "}";
+    out.flush();
+    return code;
+}
+
+}  // namespace knapsack_transport
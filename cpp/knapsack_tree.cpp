@@ -3,7 +3,8 @@
  * 
  * @author Cyans
  * @affiliation Chang'an University
- * @description Dynamic programming solution for tree knapsack problem with tree-structured dependencies between items
+ * @description Dynamic programming solution for tree knapsack problem with tree-structured dependencies between items.
+ *              The dp rows use the narrowest cell type that holds the total value (knapsack_cells.h)
  */
 
 #include <iostream>
@@ -12,12 +13,20 @@
 #include <sstream>
 #include <algorithm>
 #include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_trace_codec.h"
+#include "knapsack_kernels.h"
+#include "knapsack_cells.h"
 
 using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_tree {
 
 struct Item {
     int weight;
-    int value;
+    long long value;
     int parent;  // Parent node number (1-based), 0 means root node
 };
 
@@ -36,8 +45,12 @@ public:
         firstItem = false;
     }
     void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
     void value(const string& v) { ss << "\"" << v << "\""; }
     void value(double v) { ss << v; }
+    void raw(const string& v) { ss << v; }
+    template <class T>
+    void cell(T v) { knapsack_cells::write(ss, v); }
     void nextItem() {
         if (!firstItem) ss << ",";
         firstItem = false;
@@ -45,16 +58,56 @@ public:
     string str() { return ss.str(); }
 };
 
-vector<vector<int>> children;
-vector<Item> items;
-vector<vector<int>> dp;
-int capacity;
-JsonBuilder json;
+// State of one solve with cell type T, which holds every value the dp rows can reach; dfs and solve share
+// it instead of globals so instances can run side by side
+template <class T>
+struct TreeSolver {
+    const vector<vector<int>>& children;
+    const vector<Item>& items;
+    vector<vector<T>> dp;
+    int capacity;
+    JsonBuilder json;
+    Profiler& profiler;
+    OpCounters ops;  // Work done by the merges
+    const knapsack_kernels::RowKernels<T>& kernels = knapsack_kernels::rowKernels<T>();  // Widest ISA of this host
+    bool packed = false;  // --trace=packed: dpValues go to the delta-encoded trace
+    knapsack_trace::DeltaEncoder trace{0, "node"};
+    int lastNode = -1;
+    vector<T> lastValues;
+
+    TreeSolver(const vector<Item>& items, const vector<vector<int>>& children, int capacity, Profiler& profiler)
+        : children(children), items(items), capacity(capacity), profiler(profiler) {}
+
+    void snapshot(int u);
+    void dfs(int u);
+    int solve(const vector<int>& roots, int argc, char* argv[], chrono::high_resolution_clock::time_point startTime,
+              ostream& out);
+};
+
+// The node's dp row after a step: inline as dpValues, or in the trace as the difference to the previous
+// snapshot when that one was of the same node (a node's steps are consecutive), else to zeros
+template <class T>
+void TreeSolver<T>::snapshot(int u) {
+    if (packed) {
+        trace.row(lastNode == u ? lastValues.data() : nullptr, dp[u].data());
+        lastNode = u;
+        lastValues = dp[u];
+        return;
+    }
+    json.key("dpValues");
+    json.startArray();
+    for (int j = 0; j <= capacity; j++) {
+        json.nextItem();
+        json.cell(dp[u][j]);
+    }
+    json.endArray();
+}
 
-void dfs(int u) {
+template <class T>
+void TreeSolver<T>::dfs(int u) {
     // Initialize: must select current node to select child nodes
     int w = items[u].weight;
-    int v = items[u].value;
+    T v = (T)items[u].value;
     
     // Process all child nodes first
     for (int child : children[u]) {
@@ -63,65 +116,60 @@ void dfs(int u) {
     
     // Initialize DP array for current node
     // DP[u][j] represents max value in subtree rooted at u with capacity j
+    profiler.enter(DP);
+    ops.cells += capacity + 1;
     for (int j = w; j <= capacity; j++) {
         dp[u][j] = v;  // At least select current node
     }
     
     // Merge child node DP values (similar to group knapsack)
     for (int child : children[u]) {
+        // Enumerate capacity from large to small to avoid reuse
+        profiler.enter(DP);
+        ops.merges++;
+        if (w <= capacity) {
+            ops.candidates += (long long)(capacity - w + 1) * (capacity - w + 2) / 2;  // (j, k) pairs
+        } else {
+            ops.pruned++;  // Node never fits, the whole merge is skipped
+        }
+        kernels.maxPlusMerge(dp[u].data(), dp[child].data(), w, capacity);  // Spend k on the child's subtree
+        
         // Output step: merge child node
+        profiler.enter(SERIALIZE);
         json.nextItem();
         json.startObject();
         json.key("node"); json.value(u);
         json.key("childNode"); json.value(child);
         json.key("action"); json.value("merge");
         
-        // Enumerate capacity from large to small to avoid reuse
-        for (int j = capacity; j >= w; j--) {
-            for (int k = 0; k <= j - w; k++) {
-                if (dp[u][j] < dp[u][j - k] + dp[child][k]) {
-                    dp[u][j] = dp[u][j - k] + dp[child][k];
-                }
-            }
-        }
-        
-        json.key("dpValues");
-        json.startArray();
-        for (int j = 0; j <= capacity; j++) {
-            json.nextItem();
-            json.value(dp[u][j]);
-        }
-        json.endArray();
+        snapshot(u);
         
         json.endObject();
     }
     
+    // Find capacity corresponding to optimal value (a node heavier than the knapsack stays at 0)
+    profiler.enter(RECONSTRUCT);
+    int bestJ = min(w, capacity);
+    for (int j = w; j <= capacity; j++) {
+        if (dp[u][j] > dp[u][bestJ]) {
+            bestJ = j;
+        }
+    }
+    
     // Output step: current node processing complete
+    profiler.enter(SERIALIZE);
     json.nextItem();
     json.startObject();
     json.key("node"); json.value(u);
     json.key("action"); json.value("complete");
     json.key("w"); json.value(w);
-    json.key("v"); json.value(v);
+    json.key("v"); json.value(items[u].value);
     
-    // Find capacity corresponding to optimal value
-    int bestJ = w;
-    for (int j = w; j <= capacity; j++) {
-        if (dp[u][j] > dp[u][bestJ]) {
-            bestJ = j;
-        }
-    }
     json.key("col"); json.value(bestJ);
-    json.key("val"); json.value(dp[u][bestJ]);
-    json.key("decision"); json.value(dp[u][bestJ] > 0 ? "take" : "skip");
+    json.key("val"); json.cell(dp[u][bestJ]);
+    json.key("decision"); json.value(dp[u][bestJ] > T() ? "take" : "skip");
     
-    json.key("dpValues");
-    json.startArray();
-    for (int j = 0; j <= capacity; j++) {
-        json.nextItem();
-        json.value(dp[u][j]);
-    }
-    json.endArray();
+    snapshot(u);
     
     // Highlight parent node
     if (items[u].parent > 0) {
@@ -143,38 +191,17 @@ void dfs(int u) {
     json.endObject();
 }
 
-int main(int argc, char* argv[]) {
-    auto startTime = chrono::high_resolution_clock::now();
-    
-    if (argc < 3) {
-        cout << R"({"code":400,"error":"Insufficient parameters"})";
-        return 1;
-    }
-    
-    capacity = stoi(argv[1]);
-    int n = stoi(argv[2]);
+template <class T>
+int TreeSolver<T>::solve(const vector<int>& roots, int argc, char* argv[],
+                         chrono::high_resolution_clock::time_point startTime, ostream& out) {
+    int n = items.size();
+    profiler.setKernel(kernels.name);
     
-    items.resize(n);
-    children.resize(n);
-    dp.resize(n, vector<int>(capacity + 1, 0));
-    
-    vector<int> roots;
-    
-    for (int i = 0; i < n && i + 3 < argc; i++) {
-        string arg = argv[i + 3];
-        size_t comma1 = arg.find(',');
-        size_t comma2 = arg.find(',', comma1 + 1);
-        items[i].weight = stoi(arg.substr(0, comma1));
-        items[i].value = stoi(arg.substr(comma1 + 1, comma2 - comma1 - 1));
-        items[i].parent = stoi(arg.substr(comma2 + 1));
-        
-        if (items[i].parent == 0) {
-            roots.push_back(i);
-        } else {
-            children[items[i].parent - 1].push_back(i);
-        }
-    }
+    packed = knapsack_trace::packedRequested(argc, argv);
+    trace = knapsack_trace::DeltaEncoder(capacity + 1, "node");
+    dp.resize(n, vector<T>(capacity + 1, T()));
     
+    profiler.enter(SERIALIZE);
     json.startObject();
     json.key("code"); json.value(200);
     json.key("type"); json.value("Tree Knapsack");
@@ -225,41 +252,46 @@ int main(int argc, char* argv[]) {
     }
     
     json.endArray();
+    if (packed) {
+        json.key("trace"); json.raw(trace.json());
+    }
     
     // Calculate final result: sum of max values from all root nodes
     // If multiple roots, need to merge
-    int maxValue = 0;
+    profiler.enter(DP);
+    T maxValue = T();
     if (roots.size() == 1) {
         maxValue = dp[roots[0]][capacity];
     } else {
         // Multiple root nodes, need one group knapsack
-        vector<int> finalDp(capacity + 1, 0);
+        vector<T> finalDp(capacity + 1, T());
+        ops.merges += roots.size();
+        ops.candidates += (long long)roots.size() * (capacity + 1) * (capacity + 2) / 2;
         for (int root : roots) {
-            for (int j = capacity; j >= 0; j--) {
-                for (int k = 0; k <= j; k++) {
-                    finalDp[j] = max(finalDp[j], finalDp[j - k] + dp[root][k]);
-                }
-            }
+            kernels.maxPlusMerge(finalDp.data(), dp[root].data(), 0, capacity);
         }
         maxValue = finalDp[capacity];
     }
+    profiler.setDpCells(ops.candidates);
     
     // Backtrack path
+    profiler.enter(SERIALIZE);
     json.key("path");
     json.startArray();
     // Only mark selected root nodes
     for (int root : roots) {
-        if (dp[root][capacity] > 0) {
+        if (dp[root][capacity] > T()) {
             json.nextItem();
             json.startObject();
             json.key("node"); json.value(root);
-            json.key("val"); json.value(dp[root][capacity]);
+            json.key("val"); json.cell(dp[root][capacity]);
             json.endObject();
         }
     }
     json.endArray();
     
-    json.key("max_value"); json.value(maxValue);
+    json.key("max_value"); json.cell(maxValue);
+    json.key("cell_type"); json.value(knapsack_cells::name<T>());
     
     auto endTime = chrono::high_resolution_clock::now();
     double duration = chrono::duration<double, milli>(endTime - startTime).count();
@@ -269,15 +301,72 @@ int main(int argc, char* argv[]) {
     json.startObject();
     json.key("time"); json.value("O(n*C^2)");
     json.key("space"); json.value("O(n*C)");
-    json.key("operations"); json.value(n * (capacity + 1) * (capacity + 1));
-    json.key("memory_bytes"); json.value(n * (capacity + 1) * 4);
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((long long)n * (capacity + 1) * (long long)sizeof(T));
     json.endObject();
     
-    json.endObject();
-    cout << json.str();
+    // The root object stays open: the profile is appended after the body has been written
+    writeResult(json.str(), profiler, out);
     return 0;
 }
 
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
+    auto startTime = chrono::high_resolution_clock::now();
+    
+    if (argc < 3) {
+        out << R"({"code":400,"error":"Insufficient parameters"})";
+        return 1;
+    }
+    
+    int capacity = stoi(argv[1]);
+    int n = stoi(argv[2]);
+    
+    profiler.enter(PREPROCESS);
+    vector<Item> items(n);
+    vector<vector<int>> children(n);
+    vector<int> roots;
+    
+    for (int i = 0; i < n && i + 3 < argc; i++) {
+        string arg = argv[i + 3];
+        size_t comma1 = arg.find(',');
+        size_t comma2 = arg.find(',', comma1 + 1);
+        items[i].weight = stoi(arg.substr(0, comma1));
+        items[i].value = stoll(arg.substr(comma1 + 1, comma2 - comma1 - 1));
+        items[i].parent = stoi(arg.substr(comma2 + 1));
+        
+        if (items[i].parent == 0) {
+            roots.push_back(i);
+        } else {
+            children[items[i].parent - 1].push_back(i);
+        }
+    }
+    
+    // A subtree's value, and every candidate dp[u][j-k] + dp[child][k], stays within the sum of |v|
+    knapsack_cells::int128 bound = 0;
+    bool negative = false;
+    for (const Item& item : items) {
+        bound += item.value < 0 ? -(knapsack_cells::int128)item.value : item.value;
+        negative = negative || item.value < 0;
+    }
+    return knapsack_cells::dispatch(bound, negative, [&](auto zero) {
+        TreeSolver<decltype(zero)> solver(items, children, capacity, profiler);
+        return solver.solve(roots, argc, argv, startTime, out);
+    });
+}
+
+}  // namespace knapsack_tree
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_tree", knapsack_tree::run, argc, argv, cout);
+}
+#endif
+
 
 
 
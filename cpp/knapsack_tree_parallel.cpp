@@ -0,0 +1,383 @@
+/**
+ * Tree Knapsack Algorithm (Parallel, Solve Only)
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Tree knapsack with sibling subtrees evaluated as tasks on a work-stealing pool (thread_pool.h).
+ *              A node's task sets up its row and spawns one task per child; each finished subtree merges its
+ *              row into the parent's straight away (max-plus merges commute, so completion order does not
+ *              matter) and the last child to merge completes the parent, which in turn merges upwards.
+ *              Separate roots are independent tasks that merge into the final row the same way. Subtrees
+ *              whose merges cost less than SERIAL_WORK candidates run as one serial task, so small subtrees
+ *              do not pay for scheduling. A merged child's row is released at once, so only the rows of
+ *              subtrees still in flight are held, instead of one per node
+ *
+ * Input: Command line arguments, same as knapsack_tree, optionally followed by --threads N and --cutoff N
+ *        (subtrees below N nodes run serially)
+ * Output: Standard output in JSON format (no animation steps)
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <climits>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_cells.h"
+#include "knapsack_kernels.h"
+#include "thread_pool.h"
+
+using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_tree_parallel {
+
+// Merge candidates below which a subtree is solved serially inside one task
+const long long SERIAL_WORK = 1 << 22;
+
+struct Item {
+    int weight;
+    int value;
+    int parent;  // Parent node number (1-based), 0 means root node
+};
+
+class JsonBuilder {
+private:
+    stringstream ss;
+    bool firstItem = true;
+
+public:
+    void startObject() { ss << "{"; firstItem = true; }
+    void endObject() { ss << "}"; firstItem = false; }
+    void startArray() { ss << "["; firstItem = true; }
+    void endArray() { ss << "]"; firstItem = false; }
+
+    void key(const string& k) {
+        if (!firstItem) ss << ",";
+        ss << "\"" << k << "\":";
+        firstItem = false;
+    }
+
+    void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
+    void value(const string& v) { ss << "\"" << v << "\""; }
+    void value(double v) { ss << v; }
+
+    void nextItem() {
+        if (!firstItem) ss << ",";
+        firstItem = false;
+    }
+
+    string str() { return ss.str(); }
+};
+
+// State of one solve, shared by the tasks
+struct TreeSolver {
+    vector<vector<int>> children;
+    vector<Item> items;
+    vector<int> subtreeSize;
+    vector<vector<int>> dp;  // Row of a node from its task's start until it has merged into its parent
+    vector<unique_ptr<atomic<int>>> unmerged;  // Children of each node still to merge
+    vector<unique_ptr<mutex>> rowLock;         // Serializes merges into a node's row
+    vector<int> finalDp;                       // Group knapsack over the roots
+    mutex finalLock;
+    int capacity = 0;
+    int cutoff = 1;
+    const knapsack_kernels::Kernels& kernels = knapsack_kernels::active();  // Widest ISA of this host
+    WorkStealingPool* pool = nullptr;
+    vector<OpCounters> perWorker;
+    atomic<long long> tasks{0};
+    atomic<long long> serialSubtrees{0};
+    atomic<long long> liveRows{0};
+    atomic<long long> peakRows{0};
+
+    // Counters of the worker running this task, by its index in this solve's own pool
+    OpCounters& ops() { return perWorker[max(0, pool->workerIndex())]; }
+    void allocate(int u);
+    void release(int u);
+    long long mergeCost(int u) const;
+    void spawn(int u);
+    void solveSerial(int u);
+    void finish(int u);
+    int solve(int argc, char* argv[], ostream& out);
+};
+
+// Row of a node with only the node itself taken
+void TreeSolver::allocate(int u) {
+    dp[u].assign(capacity + 1, 0);
+    for (int j = items[u].weight; j <= capacity; j++) dp[u][j] = items[u].value;
+    ops().cells += capacity + 1;
+    long long live = liveRows.fetch_add(1) + 1;
+    long long peak = peakRows.load();
+    while (live > peak && !peakRows.compare_exchange_weak(peak, live)) {}
+}
+
+void TreeSolver::release(int u) {
+    vector<int>().swap(dp[u]);
+    liveRows.fetch_sub(1);
+}
+
+// Candidates (j, k) one child merge into u evaluates
+long long TreeSolver::mergeCost(int u) const {
+    int w = items[u].weight;
+    return w <= capacity ? (long long)(capacity - w + 1) * (capacity - w + 2) / 2 : 0;
+}
+
+// Task of node u: its whole subtree serially when small, otherwise its row plus one task per child
+void TreeSolver::spawn(int u) {
+    tasks.fetch_add(1, memory_order_relaxed);
+    if (items[u].weight > capacity) {
+        // The node never fits, so neither does anything below it
+        ops().pruned++;
+        allocate(u);
+        finish(u);
+        return;
+    }
+    if (subtreeSize[u] <= cutoff || children[u].empty()) {
+        solveSerial(u);
+        finish(u);
+        return;
+    }
+    allocate(u);
+    unmerged[u]->store((int)children[u].size());
+    for (int child : children[u]) pool->submit([this, child] { spawn(child); });
+}
+
+// Subtree of u in one task: rows set up in preorder, then merged bottom-up (reverse preorder)
+void TreeSolver::solveSerial(int u) {
+    serialSubtrees.fetch_add(1, memory_order_relaxed);
+    OpCounters& local = ops();
+    vector<int> order = {u};
+    for (size_t i = 0; i < order.size(); i++) {
+        for (int child : children[order[i]]) order.push_back(child);
+    }
+    for (int v : order) allocate(v);
+    for (size_t i = order.size() - 1; i > 0; i--) {
+        int v = order[i];
+        int p = items[v].parent - 1;
+        local.merges++;
+        if (items[p].weight <= capacity) local.candidates += mergeCost(p);
+        else local.pruned++;
+        kernels.maxPlusMerge(dp[p].data(), dp[v].data(), items[p].weight, capacity);
+        release(v);
+    }
+}
+
+// u's row is final: merge it into its parent (or the roots' row) and complete every ancestor this finishes
+void TreeSolver::finish(int u) {
+    while (true) {
+        int p = items[u].parent - 1;
+        OpCounters& local = ops();
+        local.merges++;
+        if (p < 0) {
+            lock_guard<mutex> lock(finalLock);
+            local.candidates += (long long)(capacity + 1) * (capacity + 2) / 2;
+            kernels.maxPlusMerge(finalDp.data(), dp[u].data(), 0, capacity);
+            return;  // Roots keep their rows for the path
+        }
+        {
+            lock_guard<mutex> lock(*rowLock[p]);
+            local.candidates += mergeCost(p);
+            kernels.maxPlusMerge(dp[p].data(), dp[u].data(), items[p].weight, capacity);
+        }
+        release(u);
+        if (unmerged[p]->fetch_sub(1) != 1) return;  // Siblings still running
+        u = p;
+    }
+}
+
+int TreeSolver::solve(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
+    auto startTime = chrono::high_resolution_clock::now();
+    profiler.setKernel(kernels.name);
+
+    if (argc < 3) {
+        out << R"({"code":400,"error":"Insufficient parameters"})";
+        return 1;
+    }
+
+    capacity = stoi(argv[1]);
+    int n = stoi(argv[2]);
+
+    profiler.enter(PREPROCESS);
+    items.resize(n);
+    children.resize(n);
+    vector<int> roots;
+    for (int i = 0; i < n && i + 3 < argc; i++) {
+        string arg = argv[i + 3];
+        size_t comma1 = arg.find(',');
+        size_t comma2 = arg.find(',', comma1 + 1);
+        items[i].weight = stoi(arg.substr(0, comma1));
+        items[i].value = stoi(arg.substr(comma1 + 1, comma2 - comma1 - 1));
+        items[i].parent = stoi(arg.substr(comma2 + 1));
+
+        if (items[i].parent == 0) {
+            roots.push_back(i);
+        } else {
+            children[items[i].parent - 1].push_back(i);
+        }
+    }
+
+    // A subtree's value, and every candidate of a merge, stays within the sum of |v|; the rows are int
+    knapsack_cells::int128 bound = 0;
+    for (const Item& item : items) bound += knapsack_cells::magnitude(item.value);
+    if (bound > INT_MAX) {
+        out << R"({"code":400,"error":"Total value exceeds the int range of the DP"})";
+        return 1;
+    }
+
+    // Subtree sizes bottom-up over a preorder of the forest
+    vector<int> order(roots);
+    for (size_t i = 0; i < order.size(); i++) {
+        for (int child : children[order[i]]) order.push_back(child);
+    }
+    subtreeSize.assign(n, 1);
+    for (size_t i = order.size(); i-- > 0;) {
+        if (items[order[i]].parent > 0) subtreeSize[items[order[i]].parent - 1] += subtreeSize[order[i]];
+    }
+
+    int threads = max(1u, thread::hardware_concurrency());
+    long long perNode = max(1LL, (long long)(capacity + 1) * (capacity + 2) / 2);
+    cutoff = (int)max(1LL, min<long long>(n, SERIAL_WORK / perNode));
+    for (int i = 3 + n; i + 1 < argc; i++) {
+        if (string(argv[i]) == "--threads") threads = max(1, stoi(argv[i + 1]));
+        if (string(argv[i]) == "--cutoff") cutoff = max(1, stoi(argv[i + 1]));
+    }
+
+    dp.resize(n);
+    for (int i = 0; i < n; i++) {
+        unmerged.push_back(make_unique<atomic<int>>(0));
+        rowLock.push_back(make_unique<mutex>());
+    }
+    finalDp.assign(capacity + 1, 0);
+
+    profiler.enter(DP);
+    long long steals = 0;
+    {
+        WorkStealingPool workers(threads);
+        pool = &workers;
+        perWorker.assign(workers.size(), OpCounters());
+        for (int root : roots) workers.submit([this, root] { spawn(root); });
+        workers.wait();
+        steals = workers.stealCount();
+        pool = nullptr;
+    }
+    OpCounters ops;
+    for (const OpCounters& local : perWorker) ops += local;
+    int maxValue = finalDp[capacity];
+    profiler.setDpCells(ops.candidates);
+
+    profiler.enter(SERIALIZE);
+    JsonBuilder json;
+    json.startObject();
+    json.key("code"); json.value(200);
+    json.key("type"); json.value("Tree Knapsack (Parallel)");
+    json.key("capacity"); json.value(capacity);
+
+    json.key("items");
+    json.startArray();
+    for (int i = 0; i < n; i++) {
+        json.nextItem();
+        json.startObject();
+        json.key("w"); json.value(items[i].weight);
+        json.key("v"); json.value(items[i].value);
+        json.key("p"); json.value(items[i].parent);
+        json.endObject();
+    }
+    json.endArray();
+
+    // Output tree structure
+    json.key("tree");
+    json.startObject();
+    json.key("roots");
+    json.startArray();
+    for (int r : roots) {
+        json.nextItem();
+        json.value(r);
+    }
+    json.endArray();
+    json.key("children");
+    json.startArray();
+    for (int i = 0; i < n; i++) {
+        json.nextItem();
+        json.startArray();
+        for (int c : children[i]) {
+            json.nextItem();
+            json.value(c);
+        }
+        json.endArray();
+    }
+    json.endArray();
+    json.endObject();
+
+    // No merges to animate
+    json.key("steps");
+    json.startArray();
+    json.endArray();
+
+    // Only mark selected root nodes
+    json.key("path");
+    json.startArray();
+    for (int root : roots) {
+        if (dp[root][capacity] > 0) {
+            json.nextItem();
+            json.startObject();
+            json.key("node"); json.value(root);
+            json.key("val"); json.value(dp[root][capacity]);
+            json.endObject();
+        }
+    }
+    json.endArray();
+
+    json.key("max_value"); json.value(maxValue);
+
+    json.key("parallel");
+    json.startObject();
+    json.key("threads"); json.value(threads);
+    json.key("cutoff"); json.value(cutoff);
+    json.key("tasks"); json.value(tasks.load());
+    json.key("serial_subtrees"); json.value(serialSubtrees.load());
+    json.key("steals"); json.value(steals);
+    json.key("peak_rows"); json.value(peakRows.load());
+    json.endObject();
+
+    auto endTime = chrono::high_resolution_clock::now();
+    double duration = chrono::duration<double, milli>(endTime - startTime).count();
+    json.key("time_ms"); json.value(duration);
+
+    json.key("complexity");
+    json.startObject();
+    json.key("time"); json.value("O(n*C^2/p)");
+    json.key("space"); json.value("O(n*C)");
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((peakRows.load() + 1) * (capacity + 1) * 4);
+    json.endObject();
+
+    // The root object stays open: the profile is appended after the body has been written
+    writeResult(json.str(), profiler, out);
+    return 0;
+}
+
+int run(int argc, char* argv[], ostream& out) {
+    TreeSolver solver;
+    return solver.solve(argc, argv, out);
+}
+
+}  // namespace knapsack_tree_parallel
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_tree_parallel", knapsack_tree_parallel::run, argc, argv, cout);
+}
+#endif
@@ -0,0 +1,295 @@
+/**
+ * Complete Knapsack Problem Algorithm (Periodic, Huge Capacities)
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Complete (unbounded) knapsack whose cost depends on the item weights instead of the capacity.
+ *              Let b be the item with the best value/weight ratio. Among any w_b other copies some nonempty
+ *              subset weighs a multiple of w_b and can be swapped for copies of b without losing value, so
+ *              an optimal solution takes fewer than w_b copies of the other items, weighing at most
+ *              (w_b - 1) * w_max. The DP runs over the other, undominated items only up to that bound and
+ *              the rest of the capacity is filled with b: beyond the bound the optimum is periodic in C
+ *              with period w_b and grows by v_b per period. That DP row runs through the stride-w kernel
+ *              (knapsack_kernels.h) in the narrowest cell type that holds its values (knapsack_cells.h)
+ *
+ * Input: Command line arguments, same format as knapsack_complete (64-bit capacity)
+ * Output: Standard output in JSON format (no animation steps; the path lists each chosen item once with its
+ *         count)
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_kernels.h"
+#include "knapsack_cells.h"
+
+using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_unbounded {
+
+// Largest DP below the periodicity bound, in cells
+const long long MAX_BOUND = 1LL << 28;
+
+struct Item {
+    long long weight;
+    long long value;
+};
+
+class JsonBuilder {
+private:
+    stringstream ss;
+    bool firstItem = true;
+
+public:
+    void startObject() { ss << "{"; firstItem = true; }
+    void endObject() { ss << "}"; firstItem = false; }
+    void startArray() { ss << "["; firstItem = true; }
+    void endArray() { ss << "]"; firstItem = false; }
+
+    void key(const string& k) {
+        if (!firstItem) ss << ",";
+        ss << "\"" << k << "\":";
+        firstItem = false;
+    }
+
+    void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
+    void value(const string& v) { ss << "\"" << v << "\""; }
+    void value(double v) { ss << v; }
+    template <class T>
+    void cell(T v) { knapsack_cells::write(ss, v); }
+
+    void nextItem() {
+        if (!firstItem) ss << ",";
+        firstItem = false;
+    }
+
+    string str() { return ss.str(); }
+};
+
+// a has a strictly better value/weight ratio than b (weights are positive)
+bool betterRatio(const Item& a, const Item& b) {
+    return (__int128)a.value * b.weight > (__int128)b.value * a.weight;
+}
+
+// The DP below the periodicity bound and the filled-up result for one cell type T, which holds every value
+// of that DP
+template <class T>
+int solve(long long capacity, const vector<Item>& items, const vector<int>& others, int best, long long bound,
+          OpCounters& ops, Profiler& profiler, chrono::high_resolution_clock::time_point startTime, ostream& out) {
+    int n = items.size();
+    const knapsack_kernels::RowKernels<T>& kernels = knapsack_kernels::rowKernels<T>();  // Widest ISA of this host
+    profiler.setKernel(kernels.name);
+
+    // g[r]: best value of the other items within weight r, one complete-knapsack row per item
+    profiler.enter(DP);
+    vector<T> g(bound + 1, T());
+    for (int i : others) {
+        if (items[i].weight > bound) continue;  // Never fits below the bound; its weight may not fit an int
+        kernels.unboundedRow(g.data(), (int)bound + 1, (int)items[i].weight, (T)items[i].value);
+        ops.cells += bound + 1;
+        ops.candidates += bound + 1 + max(0LL, bound - items[i].weight + 1);
+    }
+
+    // Fill the rest of the capacity with b
+    knapsack_cells::int128 maxValue = 0;
+    long long bestR = 0, fillCount = 0;
+    if (best >= 0) {
+        for (long long r = 0; r <= bound; r++) {
+            long long copies = (capacity - r) / items[best].weight;
+            knapsack_cells::int128 total = g[r] + (knapsack_cells::int128)copies * items[best].value;
+            if (total > maxValue) {
+                maxValue = total;
+                bestR = r;
+                fillCount = copies;
+            }
+        }
+        ops.merges++;  // One sweep joins the DP with the periodic part
+    }
+
+    // g[r] is 0 or g[r - w] + v of some other item, read back from the final row
+    profiler.enter(RECONSTRUCT);
+    vector<long long> counts(n, 0);
+    if (best >= 0) counts[best] = fillCount;
+    long long r = bestR;
+    bool found = true;
+    while (found && g[r] != T()) {
+        found = false;
+        for (int i : others) {
+            if (items[i].weight <= r && (T)(g[r - items[i].weight] + (T)items[i].value) == g[r]) {
+                counts[i]++;
+                r -= items[i].weight;
+                found = true;
+                break;
+            }
+        }
+    }
+
+    profiler.enter(SERIALIZE);
+    JsonBuilder json;
+    json.startObject();
+
+    json.key("code"); json.value(200);
+    json.key("type"); json.value("Complete Knapsack (Periodic)");
+    json.key("capacity"); json.value(capacity);
+
+    json.key("items");
+    json.startArray();
+    for (int i = 0; i < n; i++) {
+        json.nextItem();
+        json.startObject();
+        json.key("w"); json.value(items[i].weight);
+        json.key("v"); json.value(items[i].value);
+        json.endObject();
+    }
+    json.endArray();
+
+    // No DP table to animate
+    json.key("steps");
+    json.startArray();
+    json.endArray();
+
+    // Last item first like knapsack_complete's backtrack, one entry per item: c = capacity left before its
+    // copies are taken
+    json.key("path");
+    json.startArray();
+    long long j = capacity;
+    for (int i = n; i > 0; i--) {
+        if (counts[i - 1] == 0) continue;
+        json.nextItem();
+        json.startObject();
+        json.key("r"); json.value(i);
+        json.key("c"); json.value(j);
+        json.key("item"); json.value(i - 1);
+        json.key("count"); json.value(counts[i - 1]);
+        json.endObject();
+        j -= counts[i - 1] * items[i - 1].weight;
+    }
+    json.endArray();
+
+    json.key("max_value"); json.cell(maxValue);
+    json.key("cell_type"); json.value(knapsack_cells::name<T>());
+
+    // Filler item and the capacity beyond which the optimum repeats every w_b
+    json.key("period");
+    json.startObject();
+    json.key("item"); json.value(best);
+    json.key("length"); json.value(best >= 0 ? items[best].weight : 0LL);
+    json.key("bound"); json.value(bound);
+    json.endObject();
+
+    auto endTime = chrono::high_resolution_clock::now();
+    double duration = chrono::duration<double, milli>(endTime - startTime).count();
+    json.key("time_ms"); json.value(duration);
+
+    json.key("complexity");
+    json.startObject();
+    json.key("time"); json.value("O(n*w_b*w_max)");
+    json.key("space"); json.value("O(w_b*w_max)");
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    json.key("memory_bytes"); json.value((bound + 1) * (long long)sizeof(T));
+    json.endObject();
+
+    // The root object stays open: the profile is appended after the body has been written
+    writeResult(json.str(), profiler, out);
+    return 0;
+}
+
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
+    auto startTime = chrono::high_resolution_clock::now();
+
+    // Format: knapsack_unbounded.exe <capacity> <n> <w1,v1> <w2,v2> ...
+    if (argc < 3) {
+        out << R"({"code":400,"error":"Insufficient parameters"})";
+        return 1;
+    }
+
+    long long capacity = stoll(argv[1]);
+    int n = stoi(argv[2]);
+
+    vector<Item> items(n);
+    for (int i = 0; i < n && i + 3 < argc; i++) {
+        string arg = argv[i + 3];
+        size_t comma = arg.find(',');
+        items[i].weight = stoll(arg.substr(0, comma));
+        items[i].value = stoll(arg.substr(comma + 1));
+        if (items[i].weight <= 0 && items[i].value > 0) {
+            out << R"({"code":400,"error":"Items with value need a positive weight"})";
+            return 1;
+        }
+    }
+
+    profiler.enter(PREPROCESS);
+    OpCounters ops;
+
+    // Items that can ever be taken; the best ratio (lightest on ties) becomes the filler b
+    vector<int> useful;
+    int best = -1;
+    for (int i = 0; i < n; i++) {
+        if (items[i].value <= 0 || items[i].weight > capacity) continue;
+        useful.push_back(i);
+        if (best < 0 || betterRatio(items[i], items[best]) ||
+            (!betterRatio(items[best], items[i]) && items[i].weight < items[best].weight)) {
+            best = i;
+        }
+    }
+
+    // Remove dominated items: a lighter item worth at least as much, or copies of b that fit in the same
+    // weight and are worth at least as much
+    sort(useful.begin(), useful.end(), [&](int a, int b) {
+        return items[a].weight != items[b].weight ? items[a].weight < items[b].weight : items[a].value > items[b].value;
+    });
+    vector<int> others;
+    long long lighterBest = 0;
+    long long maxWeight = 0;
+    for (int i : useful) {
+        bool dominated = items[i].value <= lighterBest ||
+                         (items[i].weight / items[best].weight) * items[best].value >= items[i].value;
+        lighterBest = max(lighterBest, items[i].value);
+        if (i == best) continue;
+        if (dominated) {
+            ops.pruned++;
+            continue;
+        }
+        others.push_back(i);
+        maxWeight = max(maxWeight, items[i].weight);
+    }
+    ops.pruned += n - (long long)useful.size();
+
+    // Fewer than w_b copies of the other items are needed
+    long long bound = others.empty() ? 0 : min(capacity, (items[best].weight - 1) * maxWeight);
+    if (bound >= MAX_BOUND) {
+        out << R"({"code":400,"error":"Periodicity bound too large, use knapsack_complete"})";
+        return 1;
+    }
+
+    // Every cell and candidate g[r - w] + v of the other items stays within the bound filled at their best
+    // value/weight ratio
+    knapsack_cells::int128 cellBound = 0;
+    for (int i : others) {
+        cellBound = max(cellBound, max((knapsack_cells::int128)items[i].value,
+                                       (knapsack_cells::int128)items[i].value * bound / items[i].weight));
+    }
+    return knapsack_cells::dispatch(cellBound, false, [&](auto zero) {
+        return solve<decltype(zero)>(capacity, items, others, best, bound, ops, profiler, startTime, out);
+    });
+}
+
+}  // namespace knapsack_unbounded
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_unbounded", knapsack_unbounded::run, argc, argv, cout);
+}
+#endif
@@ -0,0 +1,329 @@
+/**
+ * Value-Indexed Knapsack Algorithm (0/1, Multiple, Group)
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Dual dynamic programming formulation: dp[p] = minimum weight reaching total value p.
+ *              The answer is the largest p whose weight fits. Table size is O(n * sum(v)) instead of O(n * C),
+ *              which wins when values are small integers and weights/capacity are huge
+ *
+ * Input: Command line arguments, <capacity> <model> <n> followed by items in the format of the model's solver
+ *        (01: w,v   multiple: w,v,count   group: w,v,group)
+ * Output: Standard output in JSON format (no animation steps, the path lists the chosen items)
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <climits>
+#include "knapsack_profile.h"
+#include "knapsack_transport.h"
+#include "knapsack_cells.h"
+
+using namespace std;
+using namespace knapsack_profile;
+
+namespace knapsack_value {
+
+struct Item {
+    long long weight;
+    int value;
+    int extra;  // Count (multiple) or group id (group), unused for 0/1
+};
+
+// Binary-decomposed piece of a multiple knapsack item
+struct SplitItem {
+    long long weight;
+    int value;
+    int originalIndex;
+    int splitCount;
+};
+
+class JsonBuilder {
+private:
+    stringstream ss;
+    bool firstItem = true;
+
+public:
+    void startObject() { ss << "{"; firstItem = true; }
+    void endObject() { ss << "}"; firstItem = false; }
+    void startArray() { ss << "["; firstItem = true; }
+    void endArray() { ss << "]"; firstItem = false; }
+
+    void key(const string& k) {
+        if (!firstItem) ss << ",";
+        ss << "\"" << k << "\":";
+        firstItem = false;
+    }
+
+    void value(int v) { ss << v; }
+    void value(long long v) { ss << v; }
+    void value(const string& v) { ss << "\"" << v << "\""; }
+    void value(double v) { ss << v; }
+
+    void nextItem() {
+        if (!firstItem) ss << ",";
+        firstItem = false;
+    }
+
+    string str() { return ss.str(); }
+};
+
+const long long INF = LLONG_MAX;
+
+// Largest value whose minimum weight fits into the capacity
+int bestValue(const vector<long long>& minWeight, long long capacity) {
+    for (int p = (int)minWeight.size() - 1; p > 0; p--) {
+        if (minWeight[p] <= capacity) return p;
+    }
+    return 0;
+}
+
+int run(int argc, char* argv[], ostream& out) {
+    Profiler profiler;
+    auto startTime = chrono::high_resolution_clock::now();
+
+    // Format: knapsack_value.exe <capacity> <model> <n> <item1> <item2> ...
+    if (argc < 4) {
+        out << R"({"code":400,"error":"Insufficient parameters"})";
+        return 1;
+    }
+
+    long long capacity = stoll(argv[1]);
+    string model = argv[2];
+    int n = stoi(argv[3]);
+
+    if (model != "01" && model != "multiple" && model != "group") {
+        out << R"({"code":400,"error":"Unknown model, expected 01, multiple or group"})";
+        return 1;
+    }
+
+    vector<Item> items(n);
+    for (int i = 0; i < n && i + 4 < argc; i++) {
+        string arg = argv[i + 4];
+        size_t comma1 = arg.find(',');
+        size_t comma2 = arg.find(',', comma1 + 1);
+        items[i].weight = stoll(arg.substr(0, comma1));
+        if (comma2 == string::npos) {
+            items[i].value = stoi(arg.substr(comma1 + 1));
+            items[i].extra = 1;
+        } else {
+            items[i].value = stoi(arg.substr(comma1 + 1, comma2 - comma1 - 1));
+            items[i].extra = stoi(arg.substr(comma2 + 1));
+        }
+    }
+
+    // The value columns run up to the total value (per group its largest value) and are indexed by int
+    knapsack_cells::int128 columns = 0;
+    if (model == "group") {
+        map<int, knapsack_cells::int128> groupBest;
+        for (const Item& item : items) {
+            groupBest[item.extra] = max(groupBest[item.extra], knapsack_cells::magnitude(item.value));
+        }
+        for (auto& g : groupBest) columns += g.second;
+    } else {
+        for (const Item& item : items) {
+            columns += knapsack_cells::magnitude(item.value) * (model == "multiple" ? max(0, item.extra) : 1);
+        }
+    }
+    if (columns > INT_MAX) {
+        out << R"({"code":400,"error":"Total value exceeds the int range of the DP"})";
+        return 1;
+    }
+
+    profiler.enter(SERIALIZE);
+    JsonBuilder json;
+    json.startObject();
+    json.key("code"); json.value(200);
+    json.key("type"); json.value(model == "01" ? "0/1 Knapsack (Value-Indexed)" :
+                                 model == "multiple" ? "Multiple Knapsack (Value-Indexed)" :
+                                 "Group Knapsack (Value-Indexed)");
+    json.key("capacity"); json.value(capacity);
+
+    json.key("items");
+    json.startArray();
+    for (int i = 0; i < n; i++) {
+        json.nextItem();
+        json.startObject();
+        json.key("w"); json.value(items[i].weight);
+        json.key("v"); json.value(items[i].value);
+        if (model == "multiple") { json.key("c"); json.value(items[i].extra); }
+        if (model == "group") { json.key("g"); json.value(items[i].extra); }
+        json.endObject();
+    }
+    json.endArray();
+
+    json.key("steps");
+    json.startArray();
+    json.endArray();
+
+    int valueBound = 0;   // Upper bound on the total value, i.e. the number of value columns - 1
+    long long rows = 0;   // DP rows (pieces or groups)
+    int maxValue = 0;
+    OpCounters ops;
+
+    json.key("path");
+    json.startArray();
+
+    profiler.enter(PREPROCESS);
+    if (model == "group") {
+        map<int, vector<int>> groups;
+        for (int i = 0; i < n; i++) groups[items[i].extra].push_back(i);
+
+        // At most one item per group, so the bound is the sum of the per-group maxima
+        vector<int> groupIds;
+        for (auto& g : groups) {
+            groupIds.push_back(g.first);
+            int best = 0;
+            for (int idx : g.second) best = max(best, items[idx].value);
+            valueBound += best;
+        }
+        int numGroups = groupIds.size();
+        rows = numGroups;
+
+        // choice[g][p] = item chosen in group g to reach p, -1 = inherited
+        profiler.enter(DP);
+        vector<long long> minWeight(valueBound + 1, INF);
+        minWeight[0] = 0;
+        vector<vector<int>> choice(numGroups, vector<int>(valueBound + 1, -1));
+        for (int g = 0; g < numGroups; g++) {
+            vector<long long> next = minWeight;
+            ops.cells += valueBound + 1;
+            for (int idx : groups[groupIds[g]]) {
+                int v = items[idx].value;
+                long long w = items[idx].weight;
+                long long unreachable = 0;
+                for (int p = v; p <= valueBound; p++) {
+                    if (minWeight[p - v] == INF) {
+                        unreachable++;
+                        continue;
+                    }
+                    long long nw = minWeight[p - v] + w;
+                    if (nw <= capacity && nw < next[p]) {
+                        next[p] = nw;
+                        choice[g][p] = idx;
+                    }
+                }
+                ops.candidates += max(0, valueBound - v + 1) - unreachable;
+                ops.pruned += unreachable;
+            }
+            minWeight.swap(next);
+        }
+
+        profiler.enter(RECONSTRUCT);
+        maxValue = bestValue(minWeight, capacity);
+        long long j = capacity;
+        int p = maxValue;
+        for (int g = numGroups - 1; g >= 0 && p > 0; g--) {
+            int idx = choice[g][p];
+            if (idx < 0) continue;
+            json.nextItem();
+            json.startObject();
+            json.key("r"); json.value(g + 1);
+            json.key("c"); json.value(j);
+            json.key("item"); json.value(idx);
+            json.key("group"); json.value(groupIds[g]);
+            json.endObject();
+            j -= items[idx].weight;
+            p -= items[idx].value;
+        }
+    } else {
+        // 0/1 items directly, multiple items through binary decomposition (same as knapsack_multiple)
+        vector<SplitItem> pieces;
+        for (int i = 0; i < n; i++) {
+            int cnt = model == "multiple" ? items[i].extra : 1;
+            for (int k = 1; k <= cnt; k *= 2) {
+                pieces.push_back({items[i].weight * k, items[i].value * k, i, k});
+                cnt -= k;
+            }
+            if (cnt > 0) {
+                pieces.push_back({items[i].weight * cnt, items[i].value * cnt, i, cnt});
+            }
+        }
+        int m = pieces.size();
+        rows = m;
+        for (const SplitItem& s : pieces) valueBound += s.value;
+
+        // took[i][p] = piece i improved value p
+        profiler.enter(DP);
+        vector<long long> minWeight(valueBound + 1, INF);
+        minWeight[0] = 0;
+        vector<vector<bool>> took(m, vector<bool>(valueBound + 1, false));
+        int reach = 0;
+        for (int i = 0; i < m; i++) {
+            int v = pieces[i].value;
+            long long w = pieces[i].weight;
+            long long unreachable = 0;
+            for (int p = reach; p >= 0; p--) {
+                if (minWeight[p] == INF) {
+                    unreachable++;
+                    continue;
+                }
+                long long nw = minWeight[p] + w;
+                if (nw <= capacity && nw < minWeight[p + v]) {
+                    minWeight[p + v] = nw;
+                    took[i][p + v] = true;
+                }
+            }
+            ops.cells += reach + 1;
+            ops.candidates += reach + 1 - unreachable;
+            ops.pruned += unreachable;
+            reach += v;
+        }
+
+        profiler.enter(RECONSTRUCT);
+        maxValue = bestValue(minWeight, capacity);
+        long long j = capacity;
+        int p = maxValue;
+        for (int i = m - 1; i >= 0 && p > 0; i--) {
+            if (!took[i][p]) continue;
+            json.nextItem();
+            json.startObject();
+            json.key("r"); json.value(i + 1);
+            json.key("c"); json.value(j);
+            json.key("item"); json.value(pieces[i].originalIndex);
+            if (model == "multiple") { json.key("splitCnt"); json.value(pieces[i].splitCount); }
+            json.endObject();
+            j -= pieces[i].weight;
+            p -= pieces[i].value;
+        }
+    }
+    profiler.enter(SERIALIZE);
+    json.endArray();
+
+    json.key("max_value"); json.value(maxValue);
+    json.key("engine"); json.value("value-indexed");
+    json.key("value_bound"); json.value(valueBound);
+
+    auto endTime = chrono::high_resolution_clock::now();
+    double duration = chrono::duration<double, milli>(endTime - startTime).count();
+    json.key("time_ms"); json.value(duration);
+
+    json.key("complexity");
+    json.startObject();
+    json.key("time"); json.value("O(n*Σv)");
+    json.key("space"); json.value("O(n*Σv)");
+    json.key("operations"); json.value(ops.candidates);
+    json.key("cells"); json.value(ops.cells);
+    json.key("candidates"); json.value(ops.candidates);
+    json.key("merges"); json.value(ops.merges);
+    json.key("pruned"); json.value(ops.pruned);
+    long long choiceBytes = model == "group" ? rows * (valueBound + 1) * 4 : rows * (valueBound + 1) / 8;
+    json.key("memory_bytes"); json.value((long long)(valueBound + 1) * 8 + choiceBytes);
+    json.endObject();
+
+    writeResult(json.str(), profiler, out);
+    return 0;
+}
+
+}  // namespace knapsack_value
+
+#ifndef KNAPSACK_LIBRARY
+int main(int argc, char* argv[]) {
+    return knapsack_transport::deliver("knapsack_value", knapsack_value::run, argc, argv, cout);
+}
+#endif
@@ -0,0 +1,130 @@
+/**
+ * Memory-Mapped File
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Mapping of a whole file (mmap on POSIX, MapViewOfFile on Windows): read-only for an existing
+ *              file, or read-write for a new file of a given size. An empty or missing file gives an invalid
+ *              mapping instead of an error
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class MappedFile {
+private:
+    char* ptr = nullptr;
+    size_t length = 0;
+
+    void release() {
+        if (!ptr) return;
+#ifdef _WIN32
+        UnmapViewOfFile(ptr);
+#else
+        munmap(ptr, length);
+#endif
+        ptr = nullptr;
+        length = 0;
+    }
+
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) {
+                ptr = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                if (ptr) length = (size_t)size.QuadPart;
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                ptr = static_cast<char*>(p);
+                length = (size_t)st.st_size;
+            }
+        }
+        close(fd);  // The mapping keeps the file alive
+#endif
+    }
+
+    // Create (or truncate) a file of the given size and map it for writing
+    static MappedFile create(const std::string& path, size_t size) {
+        MappedFile file;
+        if (size == 0) return file;
+#ifdef _WIN32
+        HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                                    nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) return file;
+        HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READWRITE, (DWORD)((unsigned long long)size >> 32),
+                                            (DWORD)(size & 0xFFFFFFFFu), nullptr);
+        if (mapping) {
+            file.ptr = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size));
+            if (file.ptr) file.length = size;
+            CloseHandle(mapping);
+        }
+        CloseHandle(handle);
+#else
+        int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return file;
+        if (ftruncate(fd, (off_t)size) == 0) {
+            void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) {
+                file.ptr = static_cast<char*>(p);
+                file.length = size;
+            }
+        }
+        close(fd);
+#endif
+        return file;
+    }
+
+    ~MappedFile() { release(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : ptr(std::exchange(other.ptr, nullptr)), length(std::exchange(other.length, 0)) {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            ptr = std::exchange(other.ptr, nullptr);
+            length = std::exchange(other.length, 0);
+        }
+        return *this;
+    }
+
+    bool valid() const { return ptr != nullptr; }
+    const char* data() const { return ptr; }
+    char* data() { return ptr; }
+    size_t size() const { return length; }
+};
@@ -0,0 +1,190 @@
+/**
+ * DP Row Storage
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Backing store of a full (rows x cols) DP table, indexed like a vector of rows (dp[i][j]).
+ *              In memory by default. With KNAPSACK_ROW_STORE_DIR set, a table of at least
+ *              KNAPSACK_ROW_STORE_MIN_BYTES (default 0) lives in a memory-mapped file in that directory, so
+ *              its size is bounded by disk rather than RAM:
+ *                forward pass   rows are written in order; each WRITE_BEHIND_BYTES of finished rows is queued
+ *                               for writeback, and the chunk before it is dropped from memory once on disk
+ *                backtracking   rows are prefetched in windows below the row being read
+ *              The file is a TableHeader page followed by the rows and stays in place after the run, for
+ *              knapsack_table and the visualizer; the result names it and whoever reads it last deletes it.
+ *              If the file cannot be created the table falls back to memory
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "knapsack_transport.h"
+#include "mapped_file.h"
+
+namespace knapsack_rows {
+
+constexpr char MAGIC[8] = {'K', 'N', 'A', 'P', 'R', 'O', 'W', 'S'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t HEADER_BYTES = 4096;  // Rows start page aligned
+constexpr size_t WRITE_BEHIND_BYTES = 32 * 1024 * 1024;
+constexpr size_t PREFETCH_BYTES = 32 * 1024 * 1024;
+constexpr size_t PAGE = 4096;
+
+struct TableHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t cellBytes;
+    uint64_t rows;
+    uint64_t cols;
+    char solver[32];
+};
+
+template <class T>
+class RowStore {
+private:
+    size_t rows;
+    size_t cols;
+    std::vector<T> memory;
+    MappedFile file;
+    T* cells = nullptr;
+    std::string filePath;
+#ifdef __linux__
+    int fd = -1;  // For writeback control; the mapping itself does not need it
+#endif
+    size_t flushedRows = 0;   // Rows [0, flushedRows) queued for writeback
+    size_t droppedRows = 0;   // Rows [0, droppedRows) written and released
+    size_t prefetchedFrom;    // Rows [prefetchedFrom, rows) prefetched for backtracking
+    bool reversing = false;
+
+    size_t rowBytes() const { return cols * sizeof(T); }
+    size_t offset(size_t row) const { return HEADER_BYTES + row * rowBytes(); }
+
+    // Page-aligned [begin, end) inside the byte range of rows [from, to); empty when no whole page fits
+    void pages(size_t from, size_t to, size_t& begin, size_t& end) const {
+        begin = (offset(from) + PAGE - 1) / PAGE * PAGE;
+        end = offset(to) / PAGE * PAGE;
+        if (end < begin) end = begin;
+    }
+
+    bool openMapped(const char* solver) {
+        const char* dir = std::getenv("KNAPSACK_ROW_STORE_DIR");
+        if (!dir || !*dir) return false;
+        size_t minBytes = 0;
+        if (const char* m = std::getenv("KNAPSACK_ROW_STORE_MIN_BYTES")) minBytes = std::strtoull(m, nullptr, 10);
+        if (bytes() < minBytes) return false;
+
+        std::filesystem::path path = std::filesystem::path(dir) /
+            (std::string(solver) + "-" + std::to_string(knapsack_transport::processId()) + "-" +
+             std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".rows");
+        file = MappedFile::create(path.string(), HEADER_BYTES + bytes());
+        if (!file.valid()) return false;
+        filePath = path.string();
+
+        TableHeader header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.cellBytes = sizeof(T);
+        header.rows = rows;
+        header.cols = cols;
+        std::strncpy(header.solver, solver, sizeof(header.solver) - 1);
+        std::memcpy(file.data(), &header, sizeof(header));
+        cells = reinterpret_cast<T*>(file.data() + HEADER_BYTES);
+
+#ifndef _WIN32
+        madvise(file.data(), file.size(), MADV_SEQUENTIAL);
+#endif
+#ifdef __linux__
+        fd = open(filePath.c_str(), O_RDWR);
+#endif
+        return true;
+    }
+
+public:
+    // A fresh table of zeros
+    RowStore(size_t rows, size_t cols, const char* solver) : rows(rows), cols(cols), prefetchedFrom(rows) {
+        if (!openMapped(solver)) {
+            memory.assign(rows * cols, T());
+            cells = memory.data();
+        }
+    }
+
+    ~RowStore() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    RowStore(const RowStore&) = delete;
+    RowStore& operator=(const RowStore&) = delete;
+
+    T* operator[](size_t i) { return cells + i * cols; }
+    const T* operator[](size_t i) const { return cells + i * cols; }
+
+    bool mapped() const { return file.valid(); }
+    size_t bytes() const { return rows * rowBytes(); }
+
+    // Forward pass: row i is complete, so rows before it are never read again until backtracking
+    void rowDone(size_t i) {
+        if (!mapped() || (i - flushedRows) * rowBytes() < WRITE_BEHIND_BYTES) return;
+        size_t begin, end;
+#ifdef __linux__
+        // Start writing this chunk, then wait for the previous one (long done by now) and drop it
+        pages(flushedRows, i, begin, end);
+        if (fd >= 0 && end > begin) sync_file_range(fd, begin, end - begin, SYNC_FILE_RANGE_WRITE);
+        pages(droppedRows, flushedRows, begin, end);
+        if (fd >= 0 && end > begin) {
+            sync_file_range(fd, begin, end - begin,
+                            SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+            madvise(file.data() + begin, end - begin, MADV_DONTNEED);
+            posix_fadvise(fd, begin, end - begin, POSIX_FADV_DONTNEED);
+        }
+#elif defined(_WIN32)
+        pages(flushedRows, i, begin, end);
+        if (end > begin) FlushViewOfFile(file.data() + begin, end - begin);
+#else
+        pages(flushedRows, i, begin, end);
+        if (end > begin) msync(file.data() + begin, end - begin, MS_ASYNC);
+#endif
+        droppedRows = flushedRows;
+        flushedRows = i;
+    }
+
+    // Backtracking: row i (and the rows just below it) are about to be read, in decreasing order
+    void reading(size_t i) {
+        if (!mapped() || i >= prefetchedFrom) return;
+#ifndef _WIN32
+        if (!reversing) {
+            madvise(file.data(), file.size(), MADV_NORMAL);  // Sequential readahead runs the wrong way
+            reversing = true;
+        }
+#endif
+        size_t window = std::max<size_t>(1, PREFETCH_BYTES / rowBytes());
+        size_t from = i + 1 > window ? i + 1 - window : 0;
+#ifndef _WIN32
+        size_t begin, end;
+        pages(from, i + 1, begin, end);
+        if (end > begin) madvise(file.data() + begin, end - begin, MADV_WILLNEED);
+#endif
+        prefetchedFrom = from;
+    }
+
+    // Where the table is, for the result of a mapped run
+    std::string json() const {
+        std::stringstream ss;
+        ss << "{\"backend\":\"mapped\",\"path\":\"" << knapsack_transport::escape(filePath)
+           << "\",\"header_bytes\":" << HEADER_BYTES << ",\"rows\":" << rows << ",\"cols\":" << cols
+           << ",\"bytes\":" << bytes() << "}";
+        return ss.str();
+    }
+};
+
+}  // namespace knapsack_rows
@@ -0,0 +1,140 @@
+/**
+ * Work-Stealing Thread Pool
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Fixed set of workers, each with its own task deque. A worker pops from the back of its own
+ *              deque and, when that runs dry, steals from the front of the others. Tasks submitted from
+ *              outside are dealt round-robin; tasks submitted by a worker go to that worker's deque
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<unsigned> nextQueue{0};
+    std::atomic<long long> queued{0};   // Tasks sitting in some deque
+    std::atomic<long long> pending{0};  // Tasks submitted but not finished
+    std::atomic<long long> steals{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    bool stopping = false;
+
+    // Pool and index of the worker running on this thread. Pools can nest (a solver running on a batch
+    // worker starts its own), so an index only counts for the pool recorded next to it
+    struct Current {
+        const WorkStealingPool* pool = nullptr;
+        int index = -1;
+    };
+    static Current& current() {
+        static thread_local Current worker;
+        return worker;
+    }
+    int currentWorker() const { return current().pool == this ? current().index : -1; }
+
+    bool popOwn(unsigned self, std::function<void()>& task) {
+        Queue& q = *queues[self];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) return false;
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(unsigned self, std::function<void()>& task) {
+        for (size_t k = 1; k < queues.size(); k++) {
+            Queue& q = *queues[(self + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty()) continue;
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(unsigned self) {
+        current() = {this, (int)self};
+        std::function<void()> task;
+        while (true) {
+            if (popOwn(self, task) || steal(self, task)) {
+                queued.fetch_sub(1);
+                task();
+                task = nullptr;
+                if (pending.fetch_sub(1) == 1) {
+                    std::lock_guard<std::mutex> lock(sleepMutex);
+                    finished.notify_all();
+                }
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [&] { return stopping || queued.load() > 0; });
+            if (stopping && queued.load() == 0) return;
+        }
+    }
+
+public:
+    explicit WorkStealingPool(unsigned threads) {
+        threads = std::max(1u, threads);
+        for (unsigned t = 0; t < threads; t++) queues.push_back(std::make_unique<Queue>());
+        for (unsigned t = 0; t < threads; t++) workers.emplace_back(&WorkStealingPool::workerLoop, this, t);
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& w : workers) w.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned size() const { return (unsigned)workers.size(); }
+    // Index of this thread among this pool's workers, -1 on any other thread
+    int workerIndex() const { return currentWorker(); }
+    long long stealCount() const { return steals.load(); }
+
+    void submit(std::function<void()> task) {
+        int self = currentWorker();
+        unsigned target = self >= 0 ? (unsigned)self : nextQueue.fetch_add(1) % queues.size();
+        pending.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(queues[target]->mutex);
+            queues[target]->tasks.push_back(std::move(task));
+        }
+        {
+            // Publish under the sleep mutex so a worker cannot miss the wake-up between its check and wait
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            queued.fetch_add(1);
+        }
+        wake.notify_one();
+    }
+
+    // Block until every submitted task has finished
+    void wait() {
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        finished.wait(lock, [&] { return pending.load() == 0; });
+    }
+};
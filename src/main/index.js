@@ -7,10 +7,15 @@
  */
 
 import { app, shell, BrowserWindow, ipcMain } from 'electron'
-import { join } from 'path'
+import { isAbsolute, join, relative, resolve } from 'path'
 import { spawn } from 'child_process'
+import { mkdirSync, readFileSync, realpathSync, rmSync, unlinkSync } from 'fs'
+import { tmpdir } from 'os'
 import { electronApp, optimizer, is } from '@electron-toolkit/utils'
 import icon from '../../resources/icon.png?asset'
+import { planRun, MAX_TABLE_BYTES } from './planner'
+import { ResultCache, cacheKey } from './resultCache'
+import { loadNativeSolver, solveNative } from './nativeSolver'
 
 function createWindow() {
   const mainWindow = new BrowserWindow({
@@ -41,68 +46,168 @@ function createWindow() {
   }
 }
 
-// Get C++ executable file path
+// Repeat runs are answered from memory first, then from the solvers' on-disk cache
+const resultCache = new ResultCache()
+const DISK_CACHE_BYTES = 1024 * 1024 * 1024
+
+// Get C++ executable file path (build.bat output on Windows, build.sh elsewhere)
 function getCppPath(algorithmName) {
+  const exe = process.platform === 'win32' ? `${algorithmName}.exe` : algorithmName
+  if (is.dev) {
+    return join(__dirname, '../../cpp', exe)
+  } else {
+    return join(process.resourcesPath, 'cpp', exe)
+  }
+}
+
+// Solver library addon (cpp/addon); when it is missing runs spawn the executables
+function getNativeSolverPath() {
   if (is.dev) {
-    return join(__dirname, '../../cpp', `${algorithmName}.exe`)
+    return join(__dirname, '../../cpp/addon/build/Release/knapsack.node')
   } else {
-    return join(process.resourcesPath, 'cpp', `${algorithmName}.exe`)
+    return join(process.resourcesPath, 'cpp', 'knapsack.node')
+  }
+}
+
+// Build solver command line arguments based on algorithm type
+function buildArgs(params, engineArgs = []) {
+  let args = [params.capacity.toString(), params.items.length.toString()]
+  
+  params.items.forEach(item => {
+    let itemStr = `${item.weight},${item.value}`
+    
+    // Multiple knapsack: add quantity
+    if (item.count !== undefined) {
+      itemStr += `,${item.count}`
+    }
+    // Mixed knapsack: add type
+    if (item.type !== undefined) {
+      itemStr += `,${item.type}`
+    }
+    // Two-dimensional cost: add volume
+    if (item.volume !== undefined) {
+      itemStr = `${item.weight},${item.volume},${item.value}`
+    }
+    // Group knapsack: add group ID
+    if (item.group !== undefined) {
+      itemStr += `,${item.group}`
+    }
+    // Dependency knapsack: add parent item ID
+    if (item.parent !== undefined) {
+      itemStr += `,${item.parent}`
+    }
+    
+    args.push(itemStr)
+  })
+  
+  // Two-dimensional cost: add second capacity
+  if (params.capacity2 !== undefined) {
+    args.splice(1, 0, params.capacity2.toString())
+  }
+  
+  // Kth optimal solution: add K value
+  if (params.k !== undefined) {
+    args.splice(1, 0, params.k.toString())
   }
+  
+  // Engine-specific arguments (value-indexed model, FPTAS epsilon)
+  args.splice(1, 0, ...engineArgs)
+  
+  return args
 }
 
-// Run knapsack algorithm
-function runKnapsackAlgorithm(algorithm, params) {
+// Solvers that can delta-encode their trace (knapsack_trace_codec.h); the renderer expands it again
+const PACKED_TRACE_SOLVERS = new Set(['knapsack_01', 'knapsack_count', 'knapsack_tree'])
+
+// Large results come back through a memory-mapped file in this directory (knapsack_transport.h);
+// stdout then only carries a small descriptor
+const TRANSPORT_DIR = join(tmpdir(), 'knapsack-transport')
+
+// Raw solver output as a Buffer: read from the transport file when the solver used one, else from the pipe
+function readSolverOutput(stdout) {
+  if (stdout.length < 1024 && stdout.includes('"transport":"file"')) {
+    const { path, bytes } = JSON.parse(stdout.toString())
+    const output = readFileSync(path)
+    unlinkSync(path)
+    if (output.length !== bytes) throw new Error(`Transport file truncated: ${output.length} of ${bytes} bytes`)
+    return output
+  }
+  return stdout
+}
+
+// DP tables too large for memory are kept in memory-mapped files in this directory (row_store.h). A result
+// names its table as row_store.path; knapsack_table reads it later and the directory is cleared on exit
+const ROW_STORE_DIR = join(tmpdir(), 'knapsack-rows')
+
+// Run knapsack algorithm; resolves with the solver's raw JSON bytes plus the plan and memory-cache status.
+// Aborting the signal cancels the run, in-process or spawned
+function runKnapsackAlgorithm(algorithm, params, signal) {
   return new Promise((resolve, reject) => {
-    const exePath = getCppPath(algorithm)
+    // Pick the cheapest engine for this instance
+    const plan = planRun(algorithm, params)
+    const exePath = getCppPath(plan.solver)
+    const args = buildArgs(params, plan.args)
+    // An out-of-core table has far too many cells to animate: only the result is written
+    if (plan.out_of_core) args.push('--trace=none')
+    else if (PACKED_TRACE_SOLVERS.has(plan.solver) && params.trace !== 'full') args.push('--trace=packed')
     
-    // Build command line arguments based on algorithm type
-    let args = [params.capacity.toString(), params.items.length.toString()]
+    const startTime = Date.now()
     
-    params.items.forEach(item => {
-      let itemStr = `${item.weight},${item.value}`
-      
-      // Multiple knapsack: add quantity
-      if (item.count !== undefined) {
-        itemStr += `,${item.count}`
-      }
-      // Mixed knapsack: add type
-      if (item.type !== undefined) {
-        itemStr += `,${item.type}`
-      }
-      // Two-dimensional cost: add volume
-      if (item.volume !== undefined) {
-        itemStr = `${item.weight},${item.volume},${item.value}`
-      }
-      // Group knapsack: add group ID
-      if (item.group !== undefined) {
-        itemStr += `,${item.group}`
-      }
-      // Dependency knapsack: add parent item ID
-      if (item.parent !== undefined) {
-        itemStr += `,${item.parent}`
-      }
-      
-      args.push(itemStr)
-    })
+    // Counter runs are measurements and always solve
+    const useCache = !params.counters && params.cache !== false
+    const key = cacheKey(plan.solver, args)
+    const cached = useCache ? resultCache.get(key) : undefined
+    if (cached) {
+      resolve({
+        bytes: cached,
+        cache: { hit: true, tier: 'memory', key },
+        plan: { ...plan, wall_ms: Date.now() - startTime }
+      })
+      return
+    }
     
-    // Two-dimensional cost: add second capacity
-    if (params.capacity2 !== undefined) {
-      args.splice(1, 0, params.capacity2.toString())
+    const finish = (bytes) => {
+      // A result naming a mapped table is not reused: the table file goes away with this session
+      if (useCache && !bytes.includes('"row_store":')) resultCache.set(key, bytes, bytes.length)
+      resolve({ bytes, cache: { hit: false, tier: null, key }, plan: { ...plan, wall_ms: Date.now() - startTime } })
     }
     
-    // Kth optimal solution: add K value
-    if (params.k !== undefined) {
-      args.splice(1, 0, params.k.toString())
+    // In-process through the solver library. Counter runs keep the process: perf counters and the
+    // allocation figures are per process. Out-of-core runs too, so the row store settings stay per run
+    const native = params.counters || plan.out_of_core ? null : loadNativeSolver(getNativeSolverPath())
+    if (native) {
+      console.log('Running in-process:', plan.solver, args, `(engine: ${plan.engine})`)
+      solveNative(native, plan.solver, args, signal).then(finish, (error) => {
+        reject(new Error(error.code === 'CANCELLED' ? 'Cancelled' : error.message))
+      })
+      return
     }
     
-    console.log('Running:', exePath, args)
+    console.log('Running:', exePath, args, `(engine: ${plan.engine})`)
     
-    const child = spawn(exePath, args)
-    let stdout = ''
+    mkdirSync(TRANSPORT_DIR, { recursive: true })
+    const env = { ...process.env, KNAPSACK_TRANSPORT_DIR: TRANSPORT_DIR }
+    if (useCache) {
+      env.KNAPSACK_CACHE_DIR = join(app.getPath('userData'), 'result-cache')
+      env.KNAPSACK_CACHE_BYTES = DISK_CACHE_BYTES.toString()
+    }
+    // Hardware counters around the dp phase (perf_event_open, Linux only)
+    if (params.counters) env.KNAPSACK_COUNTERS = '1'
+    if (plan.out_of_core) {
+      mkdirSync(ROW_STORE_DIR, { recursive: true })
+      env.KNAPSACK_ROW_STORE_DIR = ROW_STORE_DIR
+      env.KNAPSACK_ROW_STORE_MIN_BYTES = MAX_TABLE_BYTES.toString()
+    }
+    
+    const child = spawn(exePath, args, { env })
+    const chunks = []
     let stderr = ''
     
+    const abort = () => child.kill()
+    signal?.addEventListener('abort', abort, { once: true })
+    
     child.stdout.on('data', (data) => {
-      stdout += data.toString()
+      chunks.push(data)
     })
     
     child.stderr.on('data', (data) => {
@@ -110,22 +215,244 @@ function runKnapsackAlgorithm(algorithm, params) {
     })
     
     child.on('close', (code) => {
-      if (code === 0) {
+      signal?.removeEventListener('abort', abort)
+      const stdout = Buffer.concat(chunks)
+      if (signal?.aborted) {
+        reject(new Error('Cancelled'))
+      } else if (code === 0) {
         try {
-          const result = JSON.parse(stdout)
-          resolve(result)
+          finish(readSolverOutput(stdout))
         } catch (e) {
-          reject(new Error(`JSON parsing failed: ${e.message}\nOutput: ${stdout}`))
+          reject(new Error(`Reading result failed: ${e.message}`))
         }
       } else {
-        reject(new Error(`Process exit code: ${code}\nError: ${stderr}\nOutput: ${stdout}`))
+        reject(new Error(`Process exit code: ${code}\nError: ${stderr}\nOutput: ${stdout.toString()}`))
+      }
+    })
+    
+    child.on('error', (err) => {
+      reject(new Error(`Failed to start: ${err.message}\nPlease ensure compiled: ${exePath}`))
+    })
+  })
+}
+
+// Resolved path of a table file inside ROW_STORE_DIR, or null for anything else. The path comes from the
+// renderer, and knapsack_table deletes what it is given, so nothing outside the row store is passed on
+function rowStorePath(path) {
+  if (typeof path !== 'string') return null
+  const real = (p) => {
+    try {
+      return realpathSync(p)
+    } catch {
+      return resolve(p)
+    }
+  }
+  const file = real(resolve(path))
+  const rel = relative(real(ROW_STORE_DIR), file)
+  return rel !== '' && !rel.startsWith('..') && !isAbsolute(rel) ? file : null
+}
+
+// One knapsack_table query against a mapped table: info, row <i> [<from> <to>], cell <i> <j> or delete
+function queryTable(path, command) {
+  return new Promise((resolve, reject) => {
+    const file = rowStorePath(path)
+    if (!file) {
+      reject(new Error('Not a table in the row store directory'))
+      return
+    }
+    const exePath = getCppPath('knapsack_table')
+    const child = spawn(exePath, [file, ...command.map(String)])
+    let stdout = ''
+    
+    child.stdout.on('data', (data) => {
+      stdout += data.toString()
+    })
+    
+    child.on('close', () => {
+      try {
+        const result = JSON.parse(stdout)
+        if (result.code === 200) resolve(result)
+        else reject(new Error(result.error))
+      } catch (e) {
+        reject(new Error(`JSON parsing failed: ${e.message}`))
+      }
+    })
+    
+    child.on('error', (err) => {
+      reject(new Error(`Failed to start: ${err.message}\nPlease ensure compiled: ${exePath}`))
+    })
+  })
+}
+
+// Runs the renderer may still cancel, by its run id
+const activeRuns = new Map()
+
+function runCancellable(runId, algorithm, params) {
+  if (runId === undefined) return runKnapsackAlgorithm(algorithm, params)
+  const controller = new AbortController()
+  activeRuns.set(runId, controller)
+  return runKnapsackAlgorithm(algorithm, params, controller.signal).finally(() => activeRuns.delete(runId))
+}
+
+// Parse a run's bytes into the result object, with the plan (estimated vs actual cost) and cache status.
+// A packed trace stays packed so only the compact form crosses IPC; the renderer expands it (traceCodec.js)
+function decodeResult({ bytes, cache, plan }) {
+  const result = JSON.parse(bytes.toString())
+  result.plan = { ...plan, actual_ms: result.time_ms }
+  // The solver reports its own disk hit or miss; a memory hit overrides it
+  result.cache = cache.hit ? cache : result.cache ?? cache
+  return result
+}
+
+// Solve many instances in one knapsack_batch process; results arrive as JSON lines in completion order
+function runKnapsackBatch(instances, threads) {
+  return new Promise((resolve, reject) => {
+    const exePath = getCppPath('knapsack_batch')
+    const child = spawn(exePath, threads ? ['--threads', threads.toString()] : [])
+    const results = []
+    let summary = null
+    let buffered = ''
+    let stderr = ''
+    
+    child.stdout.on('data', (data) => {
+      buffered += data.toString()
+      let newline
+      while ((newline = buffered.indexOf('\n')) >= 0) {
+        const line = buffered.slice(0, newline)
+        buffered = buffered.slice(newline + 1)
+        if (!line) continue
+        const record = JSON.parse(line)
+        if (record.summary) summary = record.summary
+        else results.push(record)
+      }
+    })
+    
+    child.stderr.on('data', (data) => {
+      stderr += data.toString()
+    })
+    
+    child.on('close', (code) => {
+      if (code === 0) {
+        resolve({ results, summary })
+      } else {
+        reject(new Error(`Process exit code: ${code}\nError: ${stderr}`))
       }
     })
     
     child.on('error', (err) => {
       reject(new Error(`Failed to start: ${err.message}\nPlease ensure compiled: ${exePath}`))
     })
+    
+    // One line per instance: <id> <solver> <arguments...>, each instance on its planned engine
+    instances.forEach(({ id, algorithm, params }) => {
+      const plan = planRun(algorithm, { ...params, trace: params.trace ?? false })
+      child.stdin.write(`${id} ${plan.solver} ${buildArgs(params, plan.args).join(' ')}\n`)
+    })
+    child.stdin.end()
+  })
+}
+
+// Long-lived solver process speaking one JSON line per command. request(line) writes the line and resolves
+// with the next response; request(null) only waits for an unsolicited line such as a header
+function startLineProcess(exePath, args = []) {
+  const child = spawn(exePath, args)
+  const current = { child, pending: [], buffered: '', closed: false }
+  
+  child.stdout.on('data', (data) => {
+    current.buffered += data.toString()
+    let newline
+    while ((newline = current.buffered.indexOf('\n')) >= 0) {
+      const line = current.buffered.slice(0, newline)
+      current.buffered = current.buffered.slice(newline + 1)
+      const waiter = current.pending.shift()
+      if (!waiter) continue
+      try {
+        const result = JSON.parse(line)
+        if (result.code === undefined || result.code === 200) waiter.resolve(result)
+        else waiter.reject(new Error(result.error))
+      } catch (e) {
+        waiter.reject(new Error(`JSON parsing failed: ${e.message}`))
+      }
+    }
+  })
+  
+  const fail = (message) => {
+    current.closed = true
+    current.pending.forEach(({ reject }) => reject(new Error(message)))
+    current.pending = []
+  }
+  child.on('close', (code) => fail(`Process exited with code ${code}`))
+  child.on('error', (err) => fail(`Failed to start: ${err.message}\nPlease ensure compiled: ${exePath}`))
+  
+  current.request = (line) => new Promise((resolve, reject) => {
+    if (current.closed) {
+      reject(new Error('Process has exited'))
+      return
+    }
+    current.pending.push({ resolve, reject })
+    if (line !== null) child.stdin.write(line + '\n')
   })
+  return current
+}
+
+// Incremental 0/1 session: one knapsack_session process that keeps the DP table between edits and
+// answers each command with only the recomputed steps
+let session = null
+
+// Turn a renderer request into one session command line
+function sessionLine({ op, params, item, index, capacity }) {
+  switch (op) {
+    case 'reset':
+      return `reset ${buildArgs(params).join(' ')}`
+    case 'append':
+      return `append ${item.weight},${item.value}`
+    case 'capacity':
+      return `capacity ${capacity}`
+    case 'edit':
+      return `edit ${index} ${item.weight},${item.value}`
+    case 'remove':
+      return `remove ${index}`
+    default:
+      throw new Error(`Unknown session command: ${op}`)
+  }
+}
+
+function runSessionCommand(request) {
+  const line = sessionLine(request)
+  if (!session || session.closed) session = startLineProcess(getCppPath('knapsack_session'))
+  return session.request(line)
+}
+
+// Paginated steps: each stream is a knapsack_stream process that computes rows only as steps are pulled
+const streams = new Map()
+let nextStreamId = 1
+const STREAM_MODELS = { knapsack_01: '01', knapsack_complete: 'complete' }
+
+// Start a stream and return its header (items, total_steps); steps are then pulled with nextStreamSteps
+async function openStepStream(algorithm, params) {
+  const model = STREAM_MODELS[algorithm]
+  if (!model) throw new Error(`Step streaming is not available for ${algorithm}`)
+  const stream = startLineProcess(getCppPath('knapsack_stream'), buildArgs(params, [model]))
+  const header = await stream.request(null)
+  const id = nextStreamId++
+  streams.set(id, stream)
+  return { id, ...header }
+}
+
+function nextStreamSteps(id, count) {
+  const stream = streams.get(id)
+  if (!stream) return Promise.reject(new Error(`Unknown stream ${id}`))
+  return stream.request(`next ${count}`).then((page) => {
+    if (page.done) closeStepStream(id)
+    return page
+  })
+}
+
+function closeStepStream(id) {
+  const stream = streams.get(id)
+  if (!stream) return
+  streams.delete(id)
+  if (!stream.closed) stream.child.stdin.end('cancel\n')
 }
 
 app.whenReady().then(() => {
@@ -136,15 +463,84 @@ app.whenReady().then(() => {
   })
 
   // IPC: Run algorithm
-  ipcMain.handle('run-algorithm', async (event, { algorithm, params }) => {
+  ipcMain.handle('run-algorithm', async (event, { algorithm, params, runId }) => {
+    try {
+      const result = decodeResult(await runCancellable(runId, algorithm, params))
+      return { success: true, data: result }
+    } catch (error) {
+      return { success: false, error: error.message }
+    }
+  })
+
+  // IPC: Run algorithm, returning the undecoded result bytes. Structured clone copies one flat buffer
+  // instead of walking a large parsed object, and the renderer parses it itself
+  ipcMain.handle('run-algorithm-raw', async (event, { algorithm, params, runId }) => {
+    try {
+      const { bytes, cache, plan } = await runCancellable(runId, algorithm, params)
+      const view = new Uint8Array(bytes.buffer, bytes.byteOffset, bytes.length)
+      return { success: true, data: { bytes: view, cache, plan } }
+    } catch (error) {
+      return { success: false, error: error.message }
+    }
+  })
+
+  // IPC: Cancel a run started with a run id
+  ipcMain.handle('cancel-algorithm', async (event, { runId }) => {
+    activeRuns.get(runId)?.abort()
+    return { success: true }
+  })
+
+  // IPC: Run a batch of instances in one process
+  ipcMain.handle('run-batch', async (event, { instances, threads }) => {
     try {
-      const result = await runKnapsackAlgorithm(algorithm, params)
+      const result = await runKnapsackBatch(instances, threads)
       return { success: true, data: result }
     } catch (error) {
       return { success: false, error: error.message }
     }
   })
 
+  // IPC: Incremental 0/1 session (reset / append / capacity / edit / remove)
+  ipcMain.handle('session-command', async (event, request) => {
+    try {
+      const result = await runSessionCommand(request)
+      return { success: true, data: result }
+    } catch (error) {
+      return { success: false, error: error.message }
+    }
+  })
+
+  // IPC: Paginated step streams
+  ipcMain.handle('stream-open', async (event, { algorithm, params }) => {
+    try {
+      return { success: true, data: await openStepStream(algorithm, params) }
+    } catch (error) {
+      return { success: false, error: error.message }
+    }
+  })
+
+  ipcMain.handle('stream-next', async (event, { id, count }) => {
+    try {
+      return { success: true, data: await nextStreamSteps(id, count) }
+    } catch (error) {
+      return { success: false, error: error.message }
+    }
+  })
+
+  ipcMain.handle('stream-cancel', async (event, { id }) => {
+    closeStepStream(id)
+    return { success: true }
+  })
+
+  // IPC: Query a mapped DP table named by a result's row_store.path
+  ipcMain.handle('table-query', async (event, { path, command }) => {
+    try {
+      return { success: true, data: await queryTable(path, command) }
+    } catch (error) {
+      return { success: false, error: error.message }
+    }
+  })
+
   createWindow()
 
   app.on('activate', function () {
@@ -152,6 +548,12 @@ app.whenReady().then(() => {
   })
 })
 
+app.on('will-quit', () => {
+  if (session && !session.closed) session.child.stdin.end('quit\n')
+  for (const id of [...streams.keys()]) closeStepStream(id)
+  rmSync(ROW_STORE_DIR, { recursive: true, force: true })
+})
+
 app.on('window-all-closed', () => {
   if (process.platform !== 'darwin') {
     app.quit()
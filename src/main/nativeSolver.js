@@ -0,0 +1,47 @@
+/**
+ * Native Solver
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description In-process solver calls through the Node addon (cpp/addon over knapsack_api.h). Runs go to
+ *              the libuv thread pool, the output comes back as one buffer of the solver's JSON, and an
+ *              AbortSignal cancels a run at its next DP row. Without a built addon loadNativeSolver returns
+ *              null and the caller spawns the executables as before
+ */
+
+import { existsSync } from 'fs'
+
+// Must match KNAPSACK_ABI_VERSION of the library compiled into the addon
+const ABI_VERSION = 1
+
+let addon // undefined: not loaded yet, null: unavailable
+
+export function loadNativeSolver(path) {
+  if (addon !== undefined) return addon
+  addon = null
+  if (!existsSync(path)) return null
+  try {
+    const module = { exports: {} }
+    process.dlopen(module, path)
+    if (module.exports.abiVersion() === ABI_VERSION) {
+      addon = module.exports
+    } else {
+      console.warn(`Native solver ABI ${module.exports.abiVersion()} != ${ABI_VERSION}, spawning instead`)
+    }
+  } catch (error) {
+    console.warn('Native solver unavailable, spawning instead:', error.message)
+  }
+  return addon
+}
+
+// Resolves with the output as a Buffer. Rejects with error.code INVALID (message is the solver's error
+// JSON), UNKNOWN_ALGORITHM, CANCELLED or FAILED
+export function solveNative(native, solver, args, signal) {
+  const { promise, cancel } = native.solve(solver, [solver, ...args])
+  if (!signal) return promise.then((buffer) => Buffer.from(buffer))
+  if (signal.aborted) cancel()
+  signal.addEventListener('abort', cancel, { once: true })
+  return promise
+    .then((buffer) => Buffer.from(buffer))
+    .finally(() => signal.removeEventListener('abort', cancel))
+}
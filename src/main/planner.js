@@ -0,0 +1,339 @@
+/**
+ * Engine Planner
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Cost model that picks the cheapest solver executable for a run from the instance shape
+ *              (n, capacity, value range, counts, attachment fan-out) and the trace setting
+ */
+
+import { cpus } from 'os'
+
+// Rough per-unit costs in nanoseconds, calibrated on the bundled solvers
+const NS_PER_CELL = 1.5 // One DP cell without trace output (dense, value-indexed, FPTAS)
+const NS_PER_TRACE_STEP = 3000 // Building, piping and parsing one animation step
+const NS_PER_SUBSET = 100 // Meet-in-the-middle: enumerate, sort and sweep one half-subset
+const NS_PER_VECTOR_CELL = 0.3 // One cell of the vectorized rolling-row kernels
+const NS_PER_STATE = 2000 // Sparse multi-dimensional DP: generate, merge and dominance-check one state
+
+// Bytes per stored DP cell, and the largest table we are willing to allocate
+const CELL_BYTES = 4
+export const MAX_TABLE_BYTES = 2 * 1024 * 1024 * 1024
+
+// Beyond MAX_TABLE_BYTES these solvers keep their rows in a memory-mapped file (row_store.h) and run at
+// roughly disk bandwidth instead of running out of memory
+const OUT_OF_CORE_SOLVERS = new Set(['knapsack_01', 'knapsack_multiple', 'knapsack_group'])
+const DISK_BYTES_PER_MS = 200 * 1024
+
+// Above this many steps an animation is useless and the trace is dropped
+const MAX_TRACE_STEPS = 2000000
+
+// Algorithms that knapsack_rolling solves in one row, mapped to its model argument
+const ROLLING_MODELS = {
+  knapsack_complete: 'complete',
+  knapsack_mixed: 'mixed'
+}
+
+// Meet-in-the-middle enumerates 2^(n/2) subsets per half
+const MITM_MAX_ITEMS = 50
+
+// Largest DP the periodic complete knapsack runs below its bound (knapsack_unbounded MAX_BOUND)
+const PERIODIC_MAX_BOUND = 2 ** 28
+
+// Largest capacity box knapsack_nd keeps dense (DENSE_MAX_BYTES); beyond it the states go sparse
+const ND_DENSE_MAX_BYTES = 512 * 1024 * 1024
+
+// Workers knapsack_2d_parallel and knapsack_tree_parallel start by default (one per hardware thread)
+const PARALLEL_THREADS = Math.max(1, cpus().length)
+
+// Algorithms that knapsack_value can solve, mapped to its model argument
+const VALUE_INDEXED_MODELS = {
+  knapsack_01: '01',
+  knapsack_multiple: 'multiple',
+  knapsack_group: 'group'
+}
+
+// Bytes per cell of the solvers that size their cells to the value bound (knapsack_cells.h)
+function cellBytes(valueBound, negative) {
+  if (!negative && valueBound <= 0xffff) return 2
+  if (valueBound <= 2 ** 31 - 1) return 4
+  if (valueBound <= 2 ** 63 - 1) return 8
+  return 16
+}
+
+// Number of 0/1 rows after binary decomposition of a count
+function splitRows(count) {
+  return Math.max(1, Math.ceil(Math.log2(count + 1)))
+}
+
+// Nodes on the longest root-to-leaf path of a tree knapsack forest (parents are 1-based, 0 = root).
+// A parent cycle or a parent outside the item list is not a tree and is rejected
+function treeDepth(items) {
+  const depth = new Array(items.length).fill(0) // 0 = not reached yet, -1 = on the chain being walked
+  for (let i = 0; i < items.length; i++) {
+    // Walk up to the first node with a known depth, then number the walked chain downwards
+    const chain = []
+    let j = i
+    while (j >= 0 && depth[j] === 0) {
+      depth[j] = -1
+      chain.push(j)
+      j = items[j].parent - 1
+      if (j >= items.length) throw new Error(`Invalid tree: item ${chain[chain.length - 1] + 1} has no parent ${j + 1}`)
+    }
+    if (j >= 0 && depth[j] === -1) throw new Error(`Invalid tree: parent cycle through item ${j + 1}`)
+    let d = j >= 0 ? depth[j] : 0
+    for (let k = chain.length - 1; k >= 0; k--) depth[chain[k]] = ++d
+  }
+  return depth.reduce((m, d) => Math.max(m, d), 1)
+}
+
+// Shape statistics the cost model needs
+function describeInstance(algorithm, params) {
+  const items = params.items
+  const n = items.length
+  const capacity = params.capacity
+
+  // DP rows of the capacity-indexed solver
+  let rows = n
+  if (algorithm === 'knapsack_multiple') {
+    rows = items.reduce((sum, item) => sum + splitRows(item.count), 0)
+  } else if (algorithm === 'knapsack_depend') {
+    // Every main item expands into 2^attachments packages
+    const fanOut = new Map()
+    items.forEach(item => {
+      if (item.parent > 0) fanOut.set(item.parent, (fanOut.get(item.parent) || 0) + 1)
+    })
+    rows = items.reduce((sum, item, i) => sum + (item.parent > 0 ? 0 : 2 ** (fanOut.get(i + 1) || 0)), 0)
+  } else if (algorithm === 'knapsack_group') {
+    rows = new Set(items.map(item => item.group)).size
+  }
+
+  // Candidate transitions evaluated per cell
+  let perCell = 1
+  if (algorithm === 'knapsack_group') perCell = n / Math.max(1, rows)
+  if (algorithm === 'knapsack_mixed') perCell = 2
+  if (algorithm === 'knapsack_kth') perCell = params.k
+  if (algorithm === 'knapsack_tree') perCell = (capacity + 1) / 2
+  if (algorithm === 'knapsack_2d') perCell = params.capacity2 + 1
+
+  // Upper bound on the total value, i.e. the width of the value-indexed DP table
+  let valueBound = 0
+  if (algorithm === 'knapsack_group') {
+    const best = new Map()
+    items.forEach(item => best.set(item.group, Math.max(best.get(item.group) || 0, item.value)))
+    valueBound = [...best.values()].reduce((sum, v) => sum + v, 0)
+  } else {
+    valueBound = items.reduce((sum, item) => sum + item.value * (item.count !== undefined ? item.count : 1), 0)
+  }
+  const maxValue = items.reduce((m, item) => Math.max(m, item.value), 0)
+  const negative = items.some(item => item.value < 0)
+
+  return { n, capacity, rows, perCell, valueBound, maxValue, negative }
+}
+
+// Estimated cost of every engine that can solve this algorithm
+function estimateEngines(algorithm, params, shape, trace) {
+  const { n, capacity, rows, perCell, valueBound, negative } = shape
+  const engines = []
+
+  // Dense capacity-indexed DP: the algorithm's own solver, the only one that emits animation steps
+  const cells = rows * (capacity + 1)
+  let denseCellBytes = CELL_BYTES
+  if (algorithm === 'knapsack_01' || algorithm === 'knapsack_tree') {
+    denseCellBytes = cellBytes(valueBound, negative)
+  }
+  if (algorithm === 'knapsack_complete') {
+    // The whole capacity at the best value/weight ratio, as knapsack_complete bounds it
+    const completeBound = params.items.reduce((m, item) => {
+      const v = Math.abs(item.value)
+      return Math.max(m, v, Math.floor((v * capacity) / Math.max(1, item.weight)))
+    }, 0)
+    denseCellBytes = cellBytes(completeBound, negative)
+  }
+  const tableBytes = (rows + 1) * (capacity + 1) * denseCellBytes * (algorithm === 'knapsack_2d' ? params.capacity2 + 1 : 1)
+  const outOfCore = tableBytes > MAX_TABLE_BYTES && OUT_OF_CORE_SOLVERS.has(algorithm)
+  engines.push({
+    engine: 'dense',
+    solver: algorithm,
+    operations: cells * perCell,
+    estimated_ms:
+      (cells * perCell * NS_PER_CELL + (trace ? cells * NS_PER_TRACE_STEP : 0)) / 1e6 +
+      (outOfCore ? tableBytes / DISK_BYTES_PER_MS : 0),
+    memory_bytes: tableBytes,
+    trace: true,
+    out_of_core: outOfCore,
+    feasible: tableBytes <= MAX_TABLE_BYTES || outOfCore
+  })
+
+  // Meet-in-the-middle: exact 0/1, independent of capacity
+  if (algorithm === 'knapsack_01') {
+    const half = 2 ** Math.ceil(n / 2)
+    engines.push({
+      engine: 'meet-in-the-middle',
+      solver: 'knapsack_mitm',
+      operations: 2 * half,
+      estimated_ms: (2 * half * NS_PER_SUBSET) / 1e6,
+      memory_bytes: 2 * half * 24,
+      trace: false,
+      feasible: n <= MITM_MAX_ITEMS
+    })
+  }
+
+  // Value-indexed: minimum weight per value
+  if (VALUE_INDEXED_MODELS[algorithm]) {
+    const valueCells = rows * (valueBound + 1)
+    engines.push({
+      engine: 'value-indexed',
+      solver: 'knapsack_value',
+      args: [VALUE_INDEXED_MODELS[algorithm]],
+      operations: valueCells * (algorithm === 'knapsack_group' ? perCell : 1),
+      estimated_ms: (valueCells * NS_PER_CELL) / 1e6,
+      memory_bytes: (valueBound + 1) * 8 + valueCells / 8,
+      trace: false,
+      feasible: (valueBound + 1) * 8 + valueCells / 8 <= MAX_TABLE_BYTES
+    })
+  }
+
+  // Rolling row: the same DP without the table, complete items through the stride-w vector kernel
+  if (ROLLING_MODELS[algorithm]) {
+    const bounded = algorithm === 'knapsack_mixed' ? params.items.filter(item => item.type !== 1) : []
+    const pieces = bounded.reduce((sum, item) => sum + (item.type === 2 ? 2 : 1), 0)
+    const rowCells = (n - bounded.length + pieces) * (capacity + 1)
+    // Bounded copies plus the whole capacity at the best complete ratio, as knapsack_rolling bounds it
+    const rollingBound =
+      bounded.reduce((sum, item) => sum + Math.abs(item.value) * (item.type === 2 ? 3 : 1), 0) +
+      params.items
+        .filter(item => !bounded.includes(item))
+        .reduce((m, item) => Math.max(m, Math.floor((Math.abs(item.value) * capacity) / item.weight)), 0)
+    const rowBytes = (capacity + 1) * cellBytes(rollingBound, negative)
+    engines.push({
+      engine: 'rolling',
+      solver: 'knapsack_rolling',
+      args: [ROLLING_MODELS[algorithm]],
+      operations: rowCells,
+      estimated_ms: (rowCells * NS_PER_VECTOR_CELL) / 1e6,
+      memory_bytes: rowBytes * (pieces > 0 ? 3 : 1) + (pieces * (capacity + 1)) / 8,
+      trace: false,
+      feasible: true
+    })
+  }
+
+  // Periodic complete knapsack: a DP below (w_b - 1) * w_max, then copies of the best-ratio item b
+  if (algorithm === 'knapsack_complete') {
+    const useful = params.items.filter(item => item.value > 0 && item.weight > 0 && item.weight <= capacity)
+    const best = useful.reduce((b, item) => (!b || item.value * b.weight > b.value * item.weight ? item : b), null)
+    const wMax = useful.reduce((m, item) => Math.max(m, item.weight), 0)
+    const bound = best ? Math.min(capacity, (best.weight - 1) * wMax) : 0
+    const periodicBound = useful.reduce(
+      (m, item) => Math.max(m, item.value, Math.floor((item.value * bound) / item.weight)),
+      0
+    )
+    engines.push({
+      engine: 'periodic',
+      solver: 'knapsack_unbounded',
+      operations: (bound + 1) * useful.length,
+      estimated_ms: ((bound + 1) * useful.length * NS_PER_CELL) / 1e6,
+      memory_bytes: (bound + 1) * cellBytes(periodicBound, false),
+      trace: false,
+      feasible: bound < PERIODIC_MAX_BOUND
+    })
+  }
+
+  // Multi-dimensional solver: one layer of the box plus decision bits, or the sparse non-dominated states
+  if (algorithm === 'knapsack_2d') {
+    const boxCells = (capacity + 1) * (params.capacity2 + 1)
+    const denseBytes = boxCells * 8 + (n * boxCells) / 8
+    // At most one state per point of the box or per subset, usually far fewer
+    const states = Math.min(boxCells, 2 ** n)
+    const dense = denseBytes <= ND_DENSE_MAX_BYTES && boxCells <= 2 ** n
+    engines.push({
+      engine: 'multi-dimensional',
+      solver: 'knapsack_nd',
+      operations: dense ? n * boxCells : n * states,
+      estimated_ms: dense ? (n * boxCells * NS_PER_CELL) / 1e6 : (n * states * NS_PER_STATE) / 1e6,
+      memory_bytes: dense ? denseBytes : states * 28,
+      trace: false,
+      feasible: true
+    })
+
+    // Same DP with the weight slices split across threads: two planes plus one decision bit per item and cell
+    const parallelBytes = boxCells * 8 + n * (capacity + 1) * Math.ceil((params.capacity2 + 1) / 64) * 8
+    engines.push({
+      engine: 'parallel-2d',
+      solver: 'knapsack_2d_parallel',
+      operations: n * boxCells,
+      estimated_ms: (n * boxCells * NS_PER_VECTOR_CELL) / PARALLEL_THREADS / 1e6,
+      memory_bytes: parallelBytes,
+      trace: false,
+      feasible: parallelBytes <= MAX_TABLE_BYTES
+    })
+  }
+
+  // Parallel tree: subtrees as work-stealing tasks, bounded by the chain of merges along the deepest path
+  if (algorithm === 'knapsack_tree') {
+    const depth = treeDepth(params.items)
+    const parallelism = Math.max(1, Math.min(PARALLEL_THREADS, n / depth))
+    engines.push({
+      engine: 'parallel-tree',
+      solver: 'knapsack_tree_parallel',
+      operations: cells * perCell,
+      estimated_ms: (cells * perCell * NS_PER_CELL) / parallelism / 1e6,
+      memory_bytes: (n + 1) * (capacity + 1) * CELL_BYTES,
+      trace: false,
+      feasible: true
+    })
+  }
+
+  // FPTAS: only when the caller accepts an approximation
+  if (algorithm === 'knapsack_01' && params.epsilon !== undefined) {
+    const scaledSum = Math.min(valueBound, (n * n) / params.epsilon)
+    const approxCells = n * (scaledSum + 1)
+    engines.push({
+      engine: 'fptas',
+      solver: 'knapsack_fptas',
+      args: [params.epsilon.toString()],
+      operations: approxCells,
+      estimated_ms: (approxCells * NS_PER_CELL) / 1e6,
+      memory_bytes: (scaledSum + 1) * 8 + approxCells / 8,
+      trace: false,
+      feasible: true
+    })
+  }
+
+  return engines
+}
+
+/**
+ * Choose the engine for a run.
+ * A requested trace pins the run to the dense solver while the animation is still watchable;
+ * otherwise the cheapest feasible engine wins.
+ */
+export function planRun(algorithm, params) {
+  const shape = describeInstance(algorithm, params)
+  const wantTrace = params.trace !== false
+  const traceSteps = shape.rows * (shape.capacity + 1) * (algorithm === 'knapsack_2d' ? params.capacity2 + 1 : 1)
+  const trace = wantTrace && traceSteps <= MAX_TRACE_STEPS
+
+  const candidates = estimateEngines(algorithm, params, shape, trace)
+  const usable = candidates.filter(c => c.feasible && (!trace || c.trace))
+  const pool = usable.length > 0 ? usable : candidates.filter(c => c.engine === 'dense')
+  const chosen = pool.reduce((best, c) => (c.estimated_ms < best.estimated_ms ? c : best))
+
+  return {
+    engine: chosen.engine,
+    solver: chosen.solver,
+    args: chosen.args || [],
+    trace: trace && chosen.trace,
+    out_of_core: chosen.out_of_core === true,
+    estimated_ms: chosen.estimated_ms,
+    shape,
+    candidates: candidates.map(({ engine, solver, operations, estimated_ms, memory_bytes, feasible }) => ({
+      engine,
+      solver,
+      operations,
+      estimated_ms,
+      memory_bytes,
+      feasible
+    }))
+  }
+}
@@ -0,0 +1,57 @@
+/**
+ * Result Cache
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description In-memory LRU of raw solver output, keyed by a hash of the solver and its full argument
+ *              list (capacity, engine parameters, items). Sits in front of the solvers' on-disk cache
+ *              (knapsack_cache.h), so a repeated run never leaves the main process
+ */
+
+import { createHash } from 'crypto'
+
+// Budget in bytes of stored solver output
+const DEFAULT_MAX_BYTES = 128 * 1024 * 1024
+
+// Canonical key: numbers are re-printed so "05" and "5" give the same instance
+export function cacheKey(solver, args) {
+  const canonical = args.map((arg) =>
+    arg
+      .split(',')
+      .map((field) => (/^-?\d+$/.test(field) ? BigInt(field).toString() : field))
+      .join(',')
+  )
+  return createHash('sha256').update([solver, ...canonical].join('\0')).digest('hex')
+}
+
+export class ResultCache {
+  constructor(maxBytes = DEFAULT_MAX_BYTES) {
+    this.maxBytes = maxBytes
+    this.bytes = 0
+    this.entries = new Map() // Insertion order is recency order: oldest first
+  }
+
+  get(key) {
+    const entry = this.entries.get(key)
+    if (!entry) return undefined
+    this.entries.delete(key)
+    this.entries.set(key, entry)
+    return entry.result
+  }
+
+  set(key, result, bytes) {
+    if (bytes > this.maxBytes) return
+    const old = this.entries.get(key)
+    if (old) {
+      this.bytes -= old.bytes
+      this.entries.delete(key)
+    }
+    this.entries.set(key, { result, bytes })
+    this.bytes += bytes
+    for (const [oldest, entry] of this.entries) {
+      if (this.bytes <= this.maxBytes) break
+      this.entries.delete(oldest)
+      this.bytes -= entry.bytes
+    }
+  }
+}
@@ -11,10 +11,44 @@ import { electronAPI } from '@electron-toolkit/preload'
 
 // API exposed to renderer process
 const api = {
-  // Run knapsack algorithm
-  runAlgorithm: (algorithm, params) => {
+  // Run knapsack algorithm; a run started with a runId can be stopped with cancelAlgorithm(runId).
+  // A packed trace arrives as is: pass the result through expandTrace (utils/traceCodec.js) before viewing
+  runAlgorithm: (algorithm, params, runId) => {
     console.log('runAlgorithm called:', algorithm, params)
-    return ipcRenderer.invoke('run-algorithm', { algorithm, params })
+    return ipcRenderer.invoke('run-algorithm', { algorithm, params, runId })
+  },
+  // Run knapsack algorithm and get the undecoded result ({ bytes: Uint8Array, cache, plan })
+  runAlgorithmRaw: (algorithm, params, runId) => {
+    return ipcRenderer.invoke('run-algorithm-raw', { algorithm, params, runId })
+  },
+  cancelAlgorithm: (runId) => {
+    return ipcRenderer.invoke('cancel-algorithm', { runId })
+  },
+  // Run many instances ({ id, algorithm, params }) in one batch process
+  runBatch: (instances, threads) => {
+    return ipcRenderer.invoke('run-batch', { instances, threads })
+  },
+  // Incremental 0/1 session: each call returns only the steps of the recomputed cells
+  session: {
+    reset: (params) => ipcRenderer.invoke('session-command', { op: 'reset', params }),
+    append: (item) => ipcRenderer.invoke('session-command', { op: 'append', item }),
+    setCapacity: (capacity) => ipcRenderer.invoke('session-command', { op: 'capacity', capacity }),
+    edit: (index, item) => ipcRenderer.invoke('session-command', { op: 'edit', index, item }),
+    remove: (index) => ipcRenderer.invoke('session-command', { op: 'remove', index })
+  },
+  // Paginated steps (0/1 and complete): open returns the header, next pulls up to count more steps
+  stream: {
+    open: (algorithm, params) => ipcRenderer.invoke('stream-open', { algorithm, params }),
+    next: (id, count) => ipcRenderer.invoke('stream-next', { id, count }),
+    cancel: (id) => ipcRenderer.invoke('stream-cancel', { id })
+  },
+  // Out-of-core DP tables (result.row_store.path): read rows or cells on demand, release when done
+  table: {
+    info: (path) => ipcRenderer.invoke('table-query', { path, command: ['info'] }),
+    row: (path, row, from, to) =>
+      ipcRenderer.invoke('table-query', { path, command: from === undefined ? ['row', row] : ['row', row, from, to] }),
+    cell: (path, row, col) => ipcRenderer.invoke('table-query', { path, command: ['cell', row, col] }),
+    release: (path) => ipcRenderer.invoke('table-query', { path, command: ['delete'] })
   }
 }
 
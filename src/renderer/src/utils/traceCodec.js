@@ -0,0 +1,135 @@
+/**
+ * Packed Trace Decoder
+ *
+ * @author Cyans
+ * @affiliation Chang'an University
+ * @description Reads the delta-encoded "trace" of a solver run with --trace=packed (cpp/knapsack_trace_codec.h)
+ *              and restores the fields the views expect: the steps and keyframes of the 0/1 and counting
+ *              solvers, and the dpValues of every tree step
+ */
+
+const SKIP = 0
+const REPEAT = 1
+const LITERAL = 2
+
+function base64Bytes(data) {
+  const text = atob(data)
+  const bytes = new Uint8Array(text.length)
+  for (let i = 0; i < text.length; i++) bytes[i] = text.charCodeAt(i)
+  return bytes
+}
+
+// Table rows from the trace. continuesFrom(k) says whether row k is a difference to row k - 1; otherwise
+// it is a difference to zeros
+export function decodeTraceRows(trace, continuesFrom = () => true) {
+  const bytes = base64Bytes(trace.data)
+  let pos = 0
+  // Arithmetic instead of bit operations: values may exceed 32 bits
+  const varint = () => {
+    let value = 0
+    let scale = 1
+    let byte
+    do {
+      byte = bytes[pos++]
+      value += (byte & 0x7f) * scale
+      scale *= 128
+    } while (byte & 0x80)
+    return value
+  }
+  const zigzag = () => {
+    const z = varint()
+    return z % 2 === 0 ? z / 2 : -(z + 1) / 2
+  }
+
+  const rows = []
+  let prev = new Float64Array(trace.cols)
+  for (let k = 0; k < trace.rows; k++) {
+    const row = k > 0 && continuesFrom(k) ? Float64Array.from(prev) : new Float64Array(trace.cols)
+    let j = 0
+    while (j < trace.cols) {
+      const header = varint()
+      const kind = header % 4
+      const length = (header - kind) / 4
+      if (kind === REPEAT) {
+        const d = zigzag()
+        for (let m = 0; m < length; m++) row[j + m] += d
+      } else if (kind === LITERAL) {
+        for (let m = 0; m < length; m++) row[j + m] += zigzag()
+      } else if (kind !== SKIP) {
+        throw new Error(`Corrupt trace: token kind ${kind}`)
+      }
+      j += length
+    }
+    rows.push(row)
+    prev = row
+  }
+  return rows
+}
+
+// Cell steps of a row-by-row table, as knapsack_01 / knapsack_count write them without --trace=packed.
+// rows[0] is the initial row, which has no steps of its own
+function expandRowSteps(result, rows) {
+  const counting = result.type === 'Solution Counting'
+  const steps = []
+  let above = rows[0]
+  rows.slice(1).forEach((row, k) => {
+    const i = k + 1
+    const w = result.items[k].w
+    for (let j = 0; j <= result.capacity; j++) {
+      const highlight = [{ r: i - 1, c: j, type: 'without' }]
+      if (j >= w) highlight.push({ r: i - 1, c: j - w, type: 'with' })
+      if (counting) {
+        steps.push({
+          row: i, col: j, val: row[j],
+          notTake: above[j], take: j >= w ? above[j - w] : 0,
+          highlight, decision: 'add'
+        })
+      } else {
+        steps.push({ row: i, col: j, val: row[j], highlight, decision: row[j] === above[j] ? 'skip' : 'take' })
+      }
+    }
+    above = row
+  })
+  return steps
+}
+
+// Keyframes exactly as knapsack_keyframes.h records them for the full trace. Frame k follows step
+// (k + 1) * interval - 1 and holds every row touched since frame k - 1; whole rows up to the last one share
+// the decoded row instead of copying it, and the viewer (DPGrid) turns the frames into the table at each
+// keyframe, so a seek is one restore plus fewer than interval steps
+function rowKeyframes(rows, cols) {
+  const interval = Math.max(256, cols)
+  const total = (rows.length - 1) * cols
+  const frames = []
+  for (let step = interval - 1; step < total; step += interval) {
+    const last = Math.floor(step / cols) + 1
+    const col = step % cols
+    const first = Math.floor((step - interval + 1) / cols) + 1
+    const frameRows = []
+    const values = []
+    for (let r = first; r <= last; r++) {
+      frameRows.push(r)
+      values.push(r < last || col === cols - 1 ? rows[r] : Array.from(rows[r], (v, c) => (c <= col ? v : null)))
+    }
+    frames.push({ step, rows: frameRows, values })
+  }
+  return { interval, count: frames.length, frames }
+}
+
+// Restore the unpacked fields in place; results without a trace are returned unchanged
+export function expandTrace(result) {
+  const trace = result.trace
+  if (!trace) return result
+  if (trace.base === 'node') {
+    const rows = decodeTraceRows(trace, (k) => result.steps[k].node === result.steps[k - 1].node)
+    result.steps.forEach((step, k) => {
+      step.dpValues = Array.from(rows[k])
+    })
+  } else {
+    const rows = decodeTraceRows(trace)
+    result.steps = expandRowSteps(result, rows)
+    result.keyframes = rowKeyframes(rows, trace.cols)
+  }
+  delete result.trace
+  return result
+}